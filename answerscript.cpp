@@ -0,0 +1,202 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the answer-script.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "answerscript.h"
+#include "recordtraits.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <QFile>
+#include <QHostAddress>
+#include <QStringList>
+
+bool AnswerScript::load(const QString& filepath) {
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::cerr << "Script could not be opened: " << filepath.toStdString() << std::endl;
+        return false;
+    }
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    int malformed = 0;
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        QString line = QString::fromUtf8(lines.at(i));
+        const qsizetype comment = line.indexOf('#');
+        if (comment >= 0) {
+            line = line.left(comment);
+        }
+        line = line.simplified();
+        if (line.isEmpty()) {
+            continue;
+        }
+        QString name;
+        Entry entry;
+        if (!AnswerScript::parse_line(line, name, entry)) {
+            std::cerr << filepath.toStdString() << ":" << i + 1
+                      << ": expected NAME A|SRV AT-SEC TTL VALUE... (SRV-value PRIORITY:WEIGHT:PORT:TARGET)" << std::endl;
+            ++malformed;
+            continue;
+        }
+        m_script[name].append(entry);
+    }
+    for (auto it = m_script.begin(); it != m_script.end(); ++it) {
+        std::stable_sort(it.value().begin(), it.value().end(), [](const Entry& a, const Entry& b) {
+            return a.at_ms < b.at_ms;
+        });
+    }
+    return malformed == 0;
+}
+
+bool AnswerScript::parse_line(const QString& line, QString& name, Entry& entry) const {
+    const QStringList fields = line.split(' ');
+    if (fields.size() < 5) {
+        return false;
+    }
+    QDnsLookup::Type type;
+    if (!parse_record_type(fields.at(1), type) || (type != QDnsLookup::A && type != QDnsLookup::SRV)) {
+        return false;
+    }
+    bool at_ok = false;
+    bool ttl_ok = false;
+    const double at_sec = fields.at(2).toDouble(&at_ok);
+    entry.ttl = fields.at(3).toUInt(&ttl_ok);
+    if (!at_ok || !ttl_ok || at_sec < 0) {
+        return false;
+    }
+    name = AnswerScript::normalize(fields.at(0));
+    entry.type = type;
+    entry.at_ms = static_cast<qint64>(at_sec * 1000);
+
+    if (type == QDnsLookup::A) {
+        QList<DnsARecord> records;
+        for (qsizetype i = 4; i < fields.size(); ++i) {
+            DnsARecord rec;
+            rec.name = name;
+            rec.value = QHostAddress(fields.at(i));
+            rec.ttl = entry.ttl;
+            if (rec.value.protocol() != QHostAddress::IPv4Protocol) {
+                return false;
+            }
+            records.append(rec);
+        }
+        entry.records = records;
+        return true;
+    }
+
+    QList<DnsSrvRecord> records;
+    for (qsizetype i = 4; i < fields.size(); ++i) {
+        const QStringList parts = fields.at(i).split(':');
+        bool ok[3] = {false, false, false};
+        if (parts.size() != 4) {
+            return false;
+        }
+        DnsSrvRecord rec;
+        rec.name = name;
+        rec.priority = static_cast<quint16>(parts.at(0).toUInt(&ok[0]));
+        rec.weight = static_cast<quint16>(parts.at(1).toUInt(&ok[1]));
+        rec.port = static_cast<quint16>(parts.at(2).toUInt(&ok[2]));
+        rec.target = parts.at(3);
+        rec.ttl = entry.ttl;
+        if (!ok[0] || !ok[1] || !ok[2] || rec.target.isEmpty()) {
+            return false;
+        }
+        records.append(rec);
+    }
+    entry.records = records;
+    return true;
+}
+
+/*Without a script every name exists*/
+bool AnswerScript::find(const QString& name, quint16 type, qint64 now_ms, int server, quint32& ttl, DnsRecordSet& records,
+                        bool& exists) const {
+    const qint64 time_ms = now_ms - m_origin_ms;
+    if (!m_script.isEmpty()) {
+        auto it = m_script.constFind(name);
+        exists = it != m_script.constEnd();
+        if (!exists) {
+            return false;
+        }
+        const qint64 server_time_ms = time_ms - server * m_settings.stagger_ms;
+        const Entry* current = nullptr;
+        for (const auto& entry : it.value()) {
+            if (entry.type == type && entry.at_ms <= server_time_ms) {
+                current = &entry;
+            }
+        }
+        if (!current) {
+            return false;
+        }
+        ttl = current->ttl;
+        records = current->records;
+        return true;
+    }
+
+    exists = true;
+    ttl = m_settings.ttl;
+    const int current = AnswerScript::version(time_ms, server);
+    //Every name gets its own addresses, a new version changes all of them
+    const quint32 base = static_cast<quint32>(qHash(name));
+    if (type == QDnsLookup::A) {
+        QList<DnsARecord> list;
+        for (int i = 0; i < m_settings.records; ++i) {
+            const quint32 address = 0x0A000000u | ((static_cast<quint32>(current) & 0xFF) << 16) | ((base + static_cast<quint32>(i)) & 0xFFFF);
+            list.append({name, QHostAddress(address), ttl});
+        }
+        records = list;
+        return true;
+    }
+    if (type == QDnsLookup::SRV) {
+        QList<DnsSrvRecord> list;
+        for (int i = 0; i < m_settings.records; ++i) {
+            list.append({name, QString("node%1-%2.mock.test").arg(current).arg(i), 10, static_cast<quint16>(i), 5060, ttl});
+        }
+        records = list;
+        return true;
+    }
+    return false;
+}
+
+/*An empty answer is no error, like the NODATA-answer of a server*/
+DnsLookupResult AnswerScript::lookup(const QString& name, QDnsLookup::Type type, qint64 now_ms, int server) const {
+    DnsLookupResult result;
+    quint32 ttl = 0;
+    bool exists = false;
+    if (!AnswerScript::find(AnswerScript::normalize(name), type, now_ms, server, ttl, result.records, exists) && !exists) {
+        result.error = QDnsLookup::NotFoundError;
+        result.error_string = "Non existent domain";
+    }
+    return result;
+}
+
+QString AnswerScript::normalize(QString name) {
+    name = name.toLower();
+    if (name.endsWith('.')) {
+        name.chop(1);
+    }
+    return name;
+}
+
+/*Version of the generated answers, server i sees every change i * stagger later*/
+int AnswerScript::version(qint64 time_ms, int server) const {
+    time_ms -= server * m_settings.stagger_ms;
+    if (m_settings.change_at_ms < 0 || time_ms < m_settings.change_at_ms) {
+        return 0;
+    }
+    if (m_settings.change_every_ms <= 0) {
+        return 1;
+    }
+    return 1 + static_cast<int>((time_ms - m_settings.change_at_ms) / m_settings.change_every_ms);
+}
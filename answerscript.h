@@ -0,0 +1,83 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The answer-script holds the scheduled answers of the mock-responder
+ * and of the simulation. Answers come from a script (A and SRV, with TTL
+ * and scheduled versions) or are generated for every asked name: the
+ * generated answer changes at change_at and then every change_every, one
+ * server after the other with the stagger between them.
+ *
+ * Script, one version of an answer per line:
+ *   NAME TYPE AT-SEC TTL VALUE...
+ * A-values are addresses, SRV-values PRIORITY:WEIGHT:PORT:TARGET.
+ * With a script, names it does not know do not exist (NXDOMAIN).
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef ANSWERSCRIPT_H
+#define ANSWERSCRIPT_H
+
+#include <QDnsLookup>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "dnsrecord.h"
+
+class AnswerScript {
+
+public:
+    struct Settings {
+        //TTL and number of records of the generated answers
+        quint32 ttl = 60;
+        int records = 1;
+        //-1: the generated answer never changes, change_every 0: it changes only once
+        qint64 change_at_ms = -1;
+        qint64 change_every_ms = 0;
+        qint64 stagger_ms = 0;
+    };
+
+    AnswerScript() = default;
+    explicit AnswerScript(const Settings& settings) : m_settings(settings) {}
+
+    bool load(const QString& filepath);
+    //Times of the script and of the changes count from here
+    void set_origin(qint64 origin_ms) { m_origin_ms = origin_ms; }
+    const Settings& settings() const { return m_settings; }
+
+    /*Answer of server at now_ms for a lower-case name without trailing dot. exists is false
+      for a name the script does not know, false is returned if there is no answer of the type*/
+    bool find(const QString& name, quint16 type, qint64 now_ms, int server, quint32& ttl, DnsRecordSet& records,
+              bool& exists) const;
+    //Same answer as result of a lookup
+    DnsLookupResult lookup(const QString& name, QDnsLookup::Type type, qint64 now_ms, int server) const;
+
+    static QString normalize(QString name);
+
+private:
+    struct Entry {
+        quint16 type = 0;
+        qint64 at_ms = 0;
+        quint32 ttl = 0;
+        DnsRecordSet records;
+    };
+
+    Settings m_settings;
+    qint64 m_origin_ms = 0;
+    //Normalized names, the versions sorted by time
+    QHash<QString, QList<Entry>> m_script;
+
+    int version(qint64 time_ms, int server) const;
+    bool parse_line(const QString& line, QString& name, Entry& entry) const;
+};
+
+#endif // ANSWERSCRIPT_H
@@ -0,0 +1,303 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the batch-socket. Send- and receive-buffers are
+ * allocated once with MAX_BATCH fixed-size slots, so a batch does not
+ * allocate at all. io_uring is only used if it could be set up at
+ * runtime, otherwise the socket stays with sendmmsg.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "batchsocket.h"
+
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#ifdef DNS_TRACKER_HAVE_IO_URING
+#include <liburing.h>
+#endif
+
+BatchSocket::BatchSocket()
+    : m_send_sizes(MAX_BATCH, 0), m_receive_sizes(MAX_BATCH, 0) {
+    m_send_buffer.resize(MAX_BATCH * SLOT_SIZE);
+    m_receive_buffer.resize(MAX_BATCH * RECEIVE_SIZE);
+}
+
+BatchSocket::~BatchSocket() {
+    BatchSocket::close();
+}
+
+bool BatchSocket::is_supported(Mode mode) {
+#ifdef __linux__
+#ifdef DNS_TRACKER_HAVE_IO_URING
+    return true;
+#else
+    return mode == Mode::Mmsg;
+#endif
+#else
+    Q_UNUSED(mode);
+    return false;
+#endif
+}
+
+bool BatchSocket::open(const QHostAddress& server, quint16 port, Mode mode) {
+#ifdef __linux__
+    BatchSocket::close();
+
+    sockaddr_storage address;
+    socklen_t address_len = 0;
+    std::memset(&address, 0, sizeof(address));
+    if (server.protocol() == QHostAddress::IPv6Protocol) {
+        auto* in6 = reinterpret_cast<sockaddr_in6*>(&address);
+        const Q_IPV6ADDR ip = server.toIPv6Address();
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(port);
+        std::memcpy(&in6->sin6_addr, &ip, sizeof(in6->sin6_addr));
+        address_len = sizeof(sockaddr_in6);
+    } else {
+        auto* in4 = reinterpret_cast<sockaddr_in*>(&address);
+        in4->sin_family = AF_INET;
+        in4->sin_port = htons(port);
+        in4->sin_addr.s_addr = htonl(server.toIPv4Address());
+        address_len = sizeof(sockaddr_in);
+    }
+
+    m_fd = ::socket(address.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        std::cerr << "Batch-socket could not be created: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    //Replies of a whole tick arrive in a burst, give the kernel room to hold them until the next drain
+    const int receive_buffer = 4 * 1024 * 1024;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&address), address_len) < 0) {
+        std::cerr << "Batch-socket could not be connected to " << server.toString().toStdString()
+                  << ": " << std::strerror(errno) << std::endl;
+        BatchSocket::close();
+        return false;
+    }
+
+    m_mode = Mode::Mmsg;
+#ifdef DNS_TRACKER_HAVE_IO_URING
+    if (mode == Mode::Uring) {
+        auto* ring = new io_uring;
+        if (io_uring_queue_init(MAX_BATCH, ring, 0) == 0) {
+            m_uring = ring;
+            m_mode = Mode::Uring;
+        } else {
+            delete ring;
+            std::cerr << "io_uring not available, falling back to sendmmsg" << std::endl;
+        }
+    }
+#else
+    if (mode == Mode::Uring) {
+        std::cerr << "Build without io_uring, falling back to sendmmsg" << std::endl;
+    }
+#endif
+    return true;
+#else
+    Q_UNUSED(server);
+    Q_UNUSED(port);
+    Q_UNUSED(mode);
+    return false;
+#endif
+}
+
+void BatchSocket::close() {
+#ifdef DNS_TRACKER_HAVE_IO_URING
+    if (m_uring) {
+        auto* ring = static_cast<io_uring*>(m_uring);
+        io_uring_queue_exit(ring);
+        delete ring;
+        m_uring = nullptr;
+    }
+#endif
+#ifdef __linux__
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+    m_fd = -1;
+    m_queued = 0;
+}
+
+bool BatchSocket::queue(const char* data, qsizetype size) {
+    if (m_fd < 0 || size > SLOT_SIZE) {
+        return false;
+    }
+    if (m_queued == MAX_BATCH) {
+        const BatchInfo info = BatchSocket::flush();
+        if (info.messages == 0) {
+            return false;
+        }
+    }
+    std::memcpy(m_send_buffer.data() + m_queued * SLOT_SIZE, data, size);
+    m_send_sizes[m_queued] = size;
+    ++m_queued;
+    return true;
+}
+
+BatchSocket::BatchInfo BatchSocket::flush() {
+    BatchInfo info;
+    if (m_queued == 0 || m_fd < 0) {
+        return info;
+    }
+
+    int sent = 0;
+    if (m_mode == Mode::Uring) {
+        sent = BatchSocket::send_uring(0, m_queued, info.syscalls);
+    } else {
+        sent = BatchSocket::send_mmsg(0, m_queued, info.syscalls);
+    }
+    if (sent < m_queued) {
+        std::cerr << "Batch-socket dropped " << (m_queued - sent) << " of " << m_queued << " queries" << std::endl;
+    }
+
+    info.messages = sent;
+    m_queued = 0;
+    ++m_stats.send_batches;
+    m_stats.sent_messages += sent;
+    m_stats.send_syscalls += info.syscalls;
+    return info;
+}
+
+BatchSocket::BatchInfo BatchSocket::receive() {
+    BatchInfo info;
+#ifdef __linux__
+    if (m_fd < 0) {
+        return info;
+    }
+
+    mmsghdr messages[MAX_BATCH];
+    iovec vectors[MAX_BATCH];
+    std::memset(messages, 0, sizeof(messages));
+    for (int i = 0; i < MAX_BATCH; ++i) {
+        vectors[i].iov_base = m_receive_buffer.data() + i * RECEIVE_SIZE;
+        vectors[i].iov_len = RECEIVE_SIZE;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (true) {
+        const int count = ::recvmmsg(m_fd, messages, MAX_BATCH, MSG_DONTWAIT, nullptr);
+        ++info.syscalls;
+        if (count < 0) {
+            //ICMP-errors of the connected socket are reported here, retry once for pending data
+            if (errno == EINTR || errno == ECONNREFUSED) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            m_receive_sizes[i] = messages[i].msg_len;
+        }
+        info.messages = count;
+        break;
+    }
+
+    if (info.messages > 0) {
+        ++m_stats.receive_batches;
+    }
+    m_stats.received_messages += info.messages;
+    m_stats.receive_syscalls += info.syscalls;
+#endif
+    return info;
+}
+
+int BatchSocket::send_mmsg(int offset, int count, int& syscalls) {
+#ifdef __linux__
+    mmsghdr messages[MAX_BATCH];
+    iovec vectors[MAX_BATCH];
+    std::memset(messages, 0, sizeof(messages));
+    for (int i = 0; i < count; ++i) {
+        vectors[i].iov_base = m_send_buffer.data() + (offset + i) * SLOT_SIZE;
+        vectors[i].iov_len = static_cast<size_t>(m_send_sizes[offset + i]);
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = 0;
+    while (sent < count) {
+        const int result = ::sendmmsg(m_fd, messages + sent, static_cast<unsigned int>(count - sent), 0);
+        ++syscalls;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "sendmmsg failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        sent += result;
+    }
+    return sent;
+#else
+    Q_UNUSED(offset);
+    Q_UNUSED(count);
+    Q_UNUSED(syscalls);
+    return 0;
+#endif
+}
+
+int BatchSocket::send_uring(int offset, int count, int& syscalls) {
+#ifdef DNS_TRACKER_HAVE_IO_URING
+    auto* ring = static_cast<io_uring*>(m_uring);
+    msghdr headers[MAX_BATCH];
+    iovec vectors[MAX_BATCH];
+    std::memset(headers, 0, sizeof(headers));
+
+    int prepared = 0;
+    for (int i = 0; i < count; ++i) {
+        io_uring_sqe* sqe = io_uring_get_sqe(ring);
+        if (!sqe) {
+            break;
+        }
+        vectors[i].iov_base = m_send_buffer.data() + (offset + i) * SLOT_SIZE;
+        vectors[i].iov_len = static_cast<size_t>(m_send_sizes[offset + i]);
+        headers[i].msg_iov = &vectors[i];
+        headers[i].msg_iovlen = 1;
+        io_uring_prep_sendmsg(sqe, m_fd, &headers[i], 0);
+        ++prepared;
+    }
+
+    //One io_uring_enter submits all and waits for all completions
+    const int submitted = io_uring_submit_and_wait(ring, prepared);
+    ++syscalls;
+    if (submitted < 0) {
+        std::cerr << "io_uring submit failed: " << std::strerror(-submitted) << std::endl;
+        return 0;
+    }
+
+    int sent = 0;
+    for (int i = 0; i < submitted; ++i) {
+        io_uring_cqe* cqe = nullptr;
+        if (io_uring_peek_cqe(ring, &cqe) != 0 || !cqe) {
+            break;
+        }
+        if (cqe->res >= 0) {
+            ++sent;
+        }
+        io_uring_cqe_seen(ring, cqe);
+    }
+    return sent;
+#else
+    return BatchSocket::send_mmsg(offset, count, syscalls);
+#endif
+}
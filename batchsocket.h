@@ -0,0 +1,92 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The batch-socket is the batched I/O-path of the native backend (Linux
+ * only). Queries of one scheduler-tick are queued and sent with one
+ * sendmmsg (or one io_uring-submit if build with DNS_TRACKER_IO_URING),
+ * replies are drained with recvmmsg. The socket is connected to the
+ * DNS-server, so the kernel already drops datagrams of other sources.
+ * Every batch is counted together with the syscalls it needed.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef BATCHSOCKET_H
+#define BATCHSOCKET_H
+
+#include <QtGlobal>
+#include <QHostAddress>
+#include <QByteArray>
+#include <QVector>
+
+class BatchSocket {
+
+public:
+    enum class Mode {
+        Mmsg,
+        Uring
+    };
+
+    struct Stats {
+        quint64 send_batches = 0;
+        quint64 sent_messages = 0;
+        quint64 send_syscalls = 0;
+        quint64 receive_batches = 0;
+        quint64 received_messages = 0;
+        quint64 receive_syscalls = 0;
+    };
+
+    struct BatchInfo {
+        int messages = 0;
+        int syscalls = 0;
+    };
+
+    static constexpr int MAX_BATCH = 256;
+    static constexpr qsizetype SLOT_SIZE = 512;
+    static constexpr qsizetype RECEIVE_SIZE = 4096;
+
+    BatchSocket();
+    ~BatchSocket();
+    BatchSocket(const BatchSocket&) = delete;
+    BatchSocket& operator=(const BatchSocket&) = delete;
+
+    static bool is_supported(Mode mode);
+
+    bool open(const QHostAddress& server, quint16 port, Mode mode);
+    void close();
+    int fd() const { return m_fd; }
+    Mode mode() const { return m_mode; }
+
+    bool queue(const char* data, qsizetype size);
+    int queued() const { return m_queued; }
+    BatchInfo flush();
+    BatchInfo receive();
+
+    const char* datagram(int index) const { return m_receive_buffer.constData() + index * RECEIVE_SIZE; }
+    qsizetype datagram_size(int index) const { return m_receive_sizes[index]; }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    int m_fd = -1;
+    Mode m_mode = Mode::Mmsg;
+    int m_queued = 0;
+    QByteArray m_send_buffer;
+    QVector<qsizetype> m_send_sizes;
+    QByteArray m_receive_buffer;
+    QVector<qsizetype> m_receive_sizes;
+    Stats m_stats;
+    void* m_uring = nullptr;
+
+    int send_mmsg(int offset, int count, int& syscalls);
+    int send_uring(int offset, int count, int& syscalls);
+};
+
+#endif // BATCHSOCKET_H
@@ -0,0 +1,340 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The bench.cpp contains the micro-benchmarks for the hot-paths of the
+ * tracker: hashing of the RRsets, the display-update and the csv-export.
+ * Every benchmark is calibrated to run at least --min-time seconds and
+ * repeated five times, the median is reported as JSON so results of two
+ * releases can be compared by a script.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <chrono>
+#include <algorithm>
+#include <getopt.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+
+#include "dnstracker.h"
+#include "display.h"
+#include "hashing.h"
+
+/*Gives the benchmark access to the private export-functions of the display*/
+struct DisplayBenchAccess {
+    static void write(Display& display, const DnsDisplayData& data) {
+        display.write_to_csv(data);
+    }
+    static void render(Display& display) { display.render_frame(); }
+};
+
+namespace {
+
+//2025-01-01T00:00:00Z
+constexpr qint64 BENCH_TIME_MS = 1735689600000;
+
+struct BenchResult {
+    std::string name;
+    qint64 iterations = 0;
+    double ns_per_op = 0;
+    double ops_per_sec = 0;
+};
+
+struct BenchOptions {
+    double min_time = 0.2;
+    std::string filter;
+    std::string output;
+};
+
+/*Swallows the output of the render-functions*/
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+template <typename Fn>
+double time_iterations(Fn& fn, qint64 iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    fn(iterations);
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+template <typename Fn>
+void run_bench(std::vector<BenchResult>& results, const BenchOptions& opts, const std::string& name, Fn fn) {
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) {
+        return;
+    }
+
+    qint64 iterations = 1;
+    double elapsed = time_iterations(fn, iterations);
+    while (elapsed < opts.min_time / 10 && iterations < (qint64(1) << 40)) {
+        iterations *= 2;
+        elapsed = time_iterations(fn, iterations);
+    }
+    iterations = std::max<qint64>(1, static_cast<qint64>(iterations * (opts.min_time / std::max(elapsed, 1e-9))));
+
+    std::vector<double> samples;
+    for (int run = 0; run < 5; ++run) {
+        samples.push_back(time_iterations(fn, iterations) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_op = samples[samples.size() / 2];
+    result.ops_per_sec = 1e9 / result.ns_per_op;
+    results.push_back(result);
+    std::cerr << name << ": " << result.ns_per_op << " ns/op" << std::endl;
+}
+
+QList<DnsARecord> make_a_records(int count, int variant) {
+    QList<DnsARecord> records;
+    for (int i = 0; i < count; ++i) {
+        DnsARecord rec;
+        rec.name = "Bench-Host.Example.COM.";
+        rec.value = QHostAddress(0x0A000000u + static_cast<quint32>(variant * 1024 + i));
+        rec.ttl = 300;
+        records.append(rec);
+    }
+    return records;
+}
+
+QList<DnsSrvRecord> make_srv_records(int count, int variant) {
+    QList<DnsSrvRecord> records;
+    for (int i = 0; i < count; ++i) {
+        DnsSrvRecord rec;
+        rec.name = "_sip._udp.example.com";
+        rec.target = QString("Node%1-%2.Example.COM.").arg(variant).arg(i);
+        rec.priority = static_cast<quint16>(10 + i % 3);
+        rec.weight = static_cast<quint16>(i);
+        rec.port = 5060;
+        rec.ttl = 300;
+        records.append(rec);
+    }
+    return records;
+}
+
+void bench_hashing(std::vector<BenchResult>& results, const BenchOptions& opts) {
+    const int sizes[] = {1, 4, 16, 64, 256};
+    const std::pair<Hashing::Algorithm, const char*> algorithms[] = {
+        {Hashing::Algorithm::Fast128, "fast"},
+        {Hashing::Algorithm::Md5, "md5"}
+    };
+
+    for (const auto& algorithm : algorithms) {
+        Hashing::set_algorithm(algorithm.first);
+        for (int size : sizes) {
+            const auto a_records = make_a_records(size, 0);
+            run_bench(results, opts, std::string("hash_a/") + algorithm.second + "/" + std::to_string(size), [&](qint64 n) {
+                for (qint64 i = 0; i < n; ++i) {
+                    volatile auto hash = Hashing::hash_records(a_records, QDnsLookup::A).size();
+                    (void)hash;
+                }
+            });
+            const auto srv_records = make_srv_records(size, 0);
+            run_bench(results, opts, std::string("hash_srv/") + algorithm.second + "/" + std::to_string(size), [&](qint64 n) {
+                for (qint64 i = 0; i < n; ++i) {
+                    volatile auto hash = Hashing::hash_records(srv_records, QDnsLookup::SRV).size();
+                    (void)hash;
+                }
+            });
+        }
+    }
+    Hashing::set_algorithm(Hashing::Algorithm::Fast128);
+}
+
+void bench_display(std::vector<BenchResult>& results, const BenchOptions& opts) {
+    const int server_counts[] = {10, 100};
+    const int hash_counts[] = {1, 16};
+    NullBuffer null_buffer;
+
+    for (int servers : server_counts) {
+        for (int hashes : hash_counts) {
+            Options display_opts;
+            display_opts.dns_name = "bench.example.com";
+
+            QVector<DnsDisplayData> a_updates;
+            QVector<DnsDisplayData> srv_updates;
+            for (int h = 0; h < hashes; ++h) {
+                for (int s = 0; s < servers; ++s) {
+                    DnsDisplayData a_data;
+                    a_data.server_id = static_cast<quint32>(s);
+                    a_data.server = QString("10.0.%1.%2").arg(s / 256).arg(s % 256);
+                    a_data.name = display_opts.dns_name;
+                    a_data.cur_response = make_a_records(4, h);
+                    a_data.cur_hash = Hashing::hash_record_set(a_data.cur_response, QDnsLookup::A);
+                    a_data.new_hash = true;
+                    a_data.cur_time_ms = BENCH_TIME_MS;
+                    a_updates.append(a_data);
+
+                    DnsDisplayData srv_data;
+                    srv_data.server_id = a_data.server_id;
+                    srv_data.type = QDnsLookup::SRV;
+                    srv_data.server = a_data.server;
+                    srv_data.name = display_opts.dns_name;
+                    srv_data.cur_response = make_srv_records(4, h);
+                    srv_data.cur_hash = Hashing::hash_record_set(srv_data.cur_response, QDnsLookup::SRV);
+                    srv_data.new_hash = true;
+                    srv_data.cur_time_ms = BENCH_TIME_MS;
+                    srv_updates.append(srv_data);
+                }
+            }
+
+            const std::string suffix = "/servers=" + std::to_string(servers) + "/hashes=" + std::to_string(hashes);
+            std::streambuf* original = std::cout.rdbuf(&null_buffer);
+
+            //Every update is followed by a frame, the worst case without the frame-rate cap
+            {
+                Display a_display(BENCH_TIME_MS, display_opts);
+                run_bench(results, opts, "display_a" + suffix, [&](qint64 n) {
+                    for (qint64 i = 0; i < n; ++i) {
+                        a_display.update_display(a_updates[i % a_updates.size()]);
+                        DisplayBenchAccess::render(a_display);
+                    }
+                });
+                Display srv_display(BENCH_TIME_MS, display_opts);
+                run_bench(results, opts, "display_srv" + suffix, [&](qint64 n) {
+                    for (qint64 i = 0; i < n; ++i) {
+                        srv_display.update_display(srv_updates[i % srv_updates.size()]);
+                        DisplayBenchAccess::render(srv_display);
+                    }
+                });
+            }
+
+            std::cout.rdbuf(original);
+        }
+    }
+}
+
+void bench_export(std::vector<BenchResult>& results, const BenchOptions& opts) {
+    const int record_counts[] = {1, 16};
+
+    for (int records : record_counts) {
+        Options export_opts;
+        export_opts.dns_name = "bench.example.com";
+        export_opts.file_export = true;
+        export_opts.filepath = QDir(QDir::tempPath()).filePath("dns_tracker_bench_export.csv");
+        QFile::remove(export_opts.filepath);
+
+        Display display(BENCH_TIME_MS, export_opts);
+        DnsDisplayData a_data;
+        a_data.server = "10.0.0.1";
+        a_data.name = export_opts.dns_name;
+        a_data.cur_time_ms = BENCH_TIME_MS;
+        a_data.cur_response = make_a_records(records, 0);
+        run_bench(results, opts, "export_a/records=" + std::to_string(records), [&](qint64 n) {
+            for (qint64 i = 0; i < n; ++i) {
+                DisplayBenchAccess::write(display, a_data);
+            }
+        });
+
+        DnsDisplayData srv_data;
+        srv_data.server = "10.0.0.1";
+        srv_data.type = QDnsLookup::SRV;
+        srv_data.name = export_opts.dns_name;
+        srv_data.cur_time_ms = BENCH_TIME_MS;
+        srv_data.cur_response = make_srv_records(records, 0);
+        run_bench(results, opts, "export_srv/records=" + std::to_string(records), [&](qint64 n) {
+            for (qint64 i = 0; i < n; ++i) {
+                DisplayBenchAccess::write(display, srv_data);
+            }
+        });
+
+        QFile::remove(export_opts.filepath);
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\n  \"context\": {\"qt_version\": \"" << QT_VERSION_STR << "\"},\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.ns_per_op << ", \"ops_per_sec\": " << r.ops_per_sec << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void print_help() {
+    std::cout << "Usage: dns_tracker_bench [OPTION]" << std::endl;
+    std::cout << "\t--filter=TEXT (only run benchmarks containing TEXT)" << std::endl;
+    std::cout << "\t--min-time=SEC (minimum runtime per sample, default 0.2)" << std::endl;
+    std::cout << "\t--out=FILEPATH (write the JSON-result to a file instead of stdout)" << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions opts;
+    static struct option long_opts[] = {
+        {"filter", required_argument, nullptr, 'f'},
+        {"min-time", required_argument, nullptr, 'm'},
+        {"out", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:m:o:h", long_opts, nullptr)) != -1) {
+        switch (opt) {
+        case 'f':
+            opts.filter = optarg;
+            break;
+        case 'm':
+            try {
+                opts.min_time = std::stod(optarg);
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid min-time: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'o':
+            opts.output = optarg;
+            break;
+        case 'h':
+            print_help();
+            return 0;
+        default:
+            print_help();
+            return 1;
+        }
+    }
+
+    QCoreApplication app(argc, argv);
+
+    std::vector<BenchResult> results;
+    bench_hashing(results, opts);
+    bench_display(results, opts);
+    bench_export(results, opts);
+
+    if (opts.output.empty()) {
+        write_json(std::cout, results);
+    } else {
+        std::ofstream file(opts.output);
+        if (!file) {
+            std::cerr << "File could not be opended: " << opts.output << std::endl;
+            return 1;
+        }
+        write_json(file, results);
+    }
+    return 0;
+}
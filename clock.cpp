@@ -0,0 +1,65 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the system- and the virtual clock.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "clock.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+namespace {
+
+SystemClock s_system_clock;
+
+//Initialised once in a thread-safe way, the worker-threads share this clock
+const QElapsedTimer& monotonic() {
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock;
+}
+
+qint64 anchor_ms() {
+    static const qint64 anchor = QDateTime::currentMSecsSinceEpoch();
+    return anchor;
+}
+
+}
+
+std::atomic<Clock*> Clock::s_instance{&s_system_clock};
+
+void Clock::install(Clock* clock) {
+    s_instance.store(clock ? clock : &s_system_clock, std::memory_order_release);
+}
+
+/*Wall-clock of the first call, advanced by a monotonic clock, so times never jump backwards*/
+qint64 SystemClock::now_ms() const {
+    const qint64 anchor = anchor_ms();
+    return anchor + monotonic().elapsed();
+}
+
+qint64 SystemClock::now_us() const {
+    const qint64 anchor = anchor_ms();
+    return anchor * 1000 + monotonic().nsecsElapsed() / 1000;
+}
+
+void VirtualClock::advance_to(qint64 time_ms) {
+    const qint64 time_us = time_ms * 1000;
+    if (time_us > m_now_us.load(std::memory_order_relaxed)) {
+        m_now_us.store(time_us, std::memory_order_relaxed);
+    }
+}
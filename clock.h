@@ -0,0 +1,73 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The clock is the single source of time for trackers, schedulers and
+ * rate-limits. By default it is the system-clock (wall-clock of the
+ * start, advanced monotonic). The simulation installs a virtual clock
+ * instead, which only moves when the simulation advances it, so weeks
+ * of polling run as fast as the CPU allows.
+ * A clock has to be installed before anything reads the time, the
+ * schedulers and limiters keep their origin from construction.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+
+#include <QtGlobal>
+
+class Clock {
+
+public:
+    virtual ~Clock() = default;
+
+    //Epoch-ms, never jumps backwards
+    virtual qint64 now_ms() const = 0;
+    //Same time in µs, for rates
+    virtual qint64 now_us() const = 0;
+    //A virtual clock is not driven by Qt-timers
+    virtual bool is_virtual() const { return false; }
+
+    static Clock* instance() { return s_instance.load(std::memory_order_acquire); }
+    //nullptr restores the system-clock
+    static void install(Clock* clock);
+
+private:
+    static std::atomic<Clock*> s_instance;
+};
+
+class SystemClock : public Clock {
+
+public:
+    qint64 now_ms() const override;
+    qint64 now_us() const override;
+};
+
+class VirtualClock : public Clock {
+
+public:
+    explicit VirtualClock(qint64 start_ms) : m_now_us(start_ms * 1000) {}
+
+    qint64 now_ms() const override { return m_now_us.load(std::memory_order_relaxed) / 1000; }
+    qint64 now_us() const override { return m_now_us.load(std::memory_order_relaxed); }
+    bool is_virtual() const override { return true; }
+
+    //Times in the past are ignored
+    void advance_to(qint64 time_ms);
+
+private:
+    std::atomic<qint64> m_now_us;
+};
+
+#endif // CLOCK_H
@@ -0,0 +1,140 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the convergence-monitor and its propagation-report.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "convergence.h"
+#include "recordtraits.h"
+
+#include <cmath>
+
+#include <QDateTime>
+
+namespace {
+
+std::string format_delay(qint64 delay_ms) {
+    return "+" + QString::number(static_cast<double>(delay_ms) / 1000.0, 'f', 3).toStdString() + " s";
+}
+
+std::string format_time(qint64 time_ms) {
+    return QDateTime::fromMSecsSinceEpoch(time_ms).toString(Qt::ISODateWithMs).toStdString();
+}
+
+}
+
+Convergence::Convergence(double quorum, QObject* parent) : QObject(parent), m_quorum(quorum) {}
+
+void Convergence::add_server(quint32 target_id, quint32 server_id, const QString& server) {
+    m_targets[target_id].servers[server_id].server = server;
+}
+
+void Convergence::update(const DnsDisplayData& data) {
+    if (data.error != QDnsLookup::NoError || data.cur_hash.isEmpty()) {
+        return;
+    }
+    TargetState& target = m_targets[data.target_id];
+    //Answers still in flight when the polling stopped
+    if (target.converged) {
+        return;
+    }
+    if (target.name.isEmpty()) {
+        target.name = data.name;
+        target.type = data.type;
+    }
+    ServerState& state = target.servers[data.server_id];
+    if (state.server.isEmpty()) {
+        state.server = data.server;
+    }
+    if (state.hash == data.cur_hash) {
+        return;
+    }
+
+    if (state.hash.isEmpty()) {
+        //A server answering late may already see the change, its first answer is no baseline then
+        if (!target.changing) {
+            target.baseline.insert(data.cur_hash);
+        }
+    } else {
+        target.changing = true;
+        auto previous = target.counts.find(state.hash);
+        if (--previous.value() == 0) {
+            target.counts.erase(previous);
+        }
+    }
+    state.hash = data.cur_hash;
+    state.since_ms = data.cur_time_ms;
+    const int count = ++target.counts[data.cur_hash];
+
+    if (count >= Convergence::required(target) && !target.baseline.contains(data.cur_hash)) {
+        Convergence::converge(data.target_id, target, data.cur_hash, data.cur_time_ms);
+    }
+}
+
+/*Registered servers and servers seen in updates*/
+int Convergence::required(const TargetState& target) const {
+    const double servers = static_cast<double>(target.servers.size());
+    return qMax(1, static_cast<int>(std::ceil(m_quorum * servers - 1e-9)));
+}
+
+void Convergence::converge(quint32 target_id, TargetState& target, const QByteArray& hash, qint64 now_ms) {
+    target.converged = true;
+    target.converged_ms = now_ms;
+    target.onset_ms = now_ms;
+    for (auto& state : target.servers) {
+        if (state.hash == hash) {
+            state.converged_ms = state.since_ms;
+            target.onset_ms = qMin(target.onset_ms, state.since_ms);
+        }
+    }
+    ++m_converged;
+    emit converged(target_id);
+}
+
+void Convergence::print_report(std::ostream& out) const {
+    out << "Convergence (quorum " << static_cast<int>(m_quorum * 100 + 0.5) << "%): " << m_converged << " of "
+        << m_targets.size() << " target(s) converged" << std::endl;
+
+    for (const auto& target : m_targets) {
+        std::string type;
+        dispatch_record_type(target.type, [&type](auto traits) {
+            type = decltype(traits)::NAME;
+        });
+        out << target.name.toStdString() << " (" << type << "): ";
+
+        if (!target.converged) {
+            int best = 0;
+            for (auto it = target.counts.constBegin(); it != target.counts.constEnd(); ++it) {
+                if (!target.baseline.contains(it.key())) {
+                    best = qMax(best, it.value());
+                }
+            }
+            out << "not converged, " << best << "/" << target.servers.size() << " server(s) on a new answer" << std::endl;
+            continue;
+        }
+
+        out << "converged " << format_time(target.converged_ms) << ", first server " << format_time(target.onset_ms)
+            << ", spread " << format_delay(target.converged_ms - target.onset_ms) << std::endl;
+        for (const auto& state : target.servers) {
+            out << "\t" << state.server.toStdString() << "\t";
+            if (state.converged_ms >= 0) {
+                out << format_delay(state.converged_ms - target.onset_ms);
+            } else if (state.hash.isEmpty()) {
+                out << "no answer";
+            } else {
+                out << "not on the new answer";
+            }
+            out << std::endl;
+        }
+    }
+}
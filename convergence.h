@@ -0,0 +1,89 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The convergence-monitor counts per target how many servers currently
+ * return every hash, one update costs one decrement and one increment.
+ * A hash which no server returned at its first answer is a new answer.
+ * Once the quorum of the servers of a target (all by default) returns
+ * the same new answer, the target has converged: converged() is emitted
+ * so its polling can stop, and the propagation-delay of every server is
+ * kept for the report, counted from the first server with the answer.
+ * It is fed on the main-thread by the display.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef CONVERGENCE_H
+#define CONVERGENCE_H
+
+#include <ostream>
+
+#include <QObject>
+#include <QByteArray>
+#include <QDnsLookup>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include "dnstracker.h"
+
+class Convergence : public QObject {
+    Q_OBJECT
+
+public:
+    //quorum is the share of servers (0..1] which has to return the new answer
+    explicit Convergence(double quorum, QObject* parent = nullptr);
+
+    //Servers which never answer are counted for the quorum as well
+    void add_server(quint32 target_id, quint32 server_id, const QString& server);
+    void update(const DnsDisplayData& data);
+
+    int converged_targets() const { return m_converged; }
+    void print_report(std::ostream& out) const;
+
+signals:
+    void converged(quint32 target_id);
+
+private:
+    struct ServerState {
+        QString server;
+        QByteArray hash;
+        //Time of the first answer with the current hash
+        qint64 since_ms = -1;
+        //Time the server returned the converged hash, -1 if it had not when the target converged
+        qint64 converged_ms = -1;
+    };
+
+    struct TargetState {
+        QString name;
+        QDnsLookup::Type type = QDnsLookup::A;
+        QHash<quint32, ServerState> servers;
+        //Servers currently returning the hash
+        QHash<QByteArray, int> counts;
+        //First answers of the servers, every other hash is a new answer
+        QSet<QByteArray> baseline;
+        //A server left its first answer
+        bool changing = false;
+        bool converged = false;
+        qint64 onset_ms = -1;
+        qint64 converged_ms = -1;
+    };
+
+    double m_quorum;
+    QHash<quint32, TargetState> m_targets;
+    int m_converged = 0;
+
+    int required(const TargetState& target) const;
+    void converge(quint32 target_id, TargetState& target, const QByteArray& hash, qint64 now_ms);
+};
+
+#endif // CONVERGENCE_H
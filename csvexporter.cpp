@@ -0,0 +1,164 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the csv-exporter. The producer only blocks if the
+ * ring-buffer is full (disk stalled), otherwise append() is a move into
+ * the ring under a short lock. The writer concatenates a whole batch and
+ * writes it with one call.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "csvexporter.h"
+#include "tracing.h"
+
+#include <iostream>
+#include <chrono>
+
+#include <unistd.h>
+
+CsvExporter::CsvExporter(const QString& filepath, const Settings& settings)
+    : m_filepath(filepath), m_settings(settings), m_file(filepath) {
+    if (m_settings.capacity == 0) {
+        m_settings.capacity = 1;
+    }
+    if (m_settings.flush_rows == 0 || m_settings.flush_rows > m_settings.capacity) {
+        m_settings.flush_rows = m_settings.capacity;
+    }
+    m_ring.resize(static_cast<qsizetype>(m_settings.capacity));
+}
+
+CsvExporter::~CsvExporter() {
+    CsvExporter::close();
+}
+
+bool CsvExporter::open() {
+    if (m_writer.joinable()) {
+        return true;
+    }
+    const QIODevice::OpenMode mode = m_settings.text_mode ? (QIODevice::Append | QIODevice::Text) : QIODevice::Append;
+    if (!m_file.open(mode)) {
+        std::cerr << "File could not be opended: " << m_filepath.toStdString() << std::endl;
+        return false;
+    }
+    m_stop = false;
+    m_writer = std::thread(&CsvExporter::run, this);
+    return true;
+}
+
+void CsvExporter::append(QByteArray row) {
+    if (!m_writer.joinable()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_space.wait(lock, [this]() { return m_count < m_settings.capacity || m_stop; });
+    if (m_stop) {
+        return;
+    }
+
+    m_ring[static_cast<qsizetype>((m_head + m_count) % m_settings.capacity)] = std::move(row);
+    ++m_count;
+    m_depth.store(m_count, std::memory_order_relaxed);
+    const bool wake = m_count >= m_settings.flush_rows || m_settings.fsync == FsyncPolicy::Always;
+    lock.unlock();
+
+    if (wake) {
+        m_wakeup.notify_one();
+    }
+}
+
+void CsvExporter::close() {
+    if (!m_writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeup.notify_one();
+    m_space.notify_all();
+    m_writer.join();
+    m_file.close();
+}
+
+void CsvExporter::run() {
+    QVector<QByteArray> batch;
+    batch.reserve(static_cast<qsizetype>(m_settings.capacity));
+    QByteArray buffer;
+
+    while (true) {
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait_for(lock, std::chrono::milliseconds(m_settings.flush_interval_ms), [this]() {
+                return m_stop || m_count >= m_settings.flush_rows
+                       || (m_settings.fsync == FsyncPolicy::Always && m_count > 0);
+            });
+
+            while (m_count > 0) {
+                batch.append(std::move(m_ring[static_cast<qsizetype>(m_head)]));
+                m_ring[static_cast<qsizetype>(m_head)] = QByteArray();
+                m_head = (m_head + 1) % m_settings.capacity;
+                --m_count;
+            }
+            m_depth.store(0, std::memory_order_relaxed);
+            stop = m_stop;
+        }
+        m_space.notify_all();
+
+        if (!batch.isEmpty()) {
+            CsvExporter::write_batch(batch, buffer);
+        }
+        if (stop) {
+            //Final flush, the data is on disk when close() returns
+            m_file.flush();
+            if (m_settings.fsync != FsyncPolicy::Never) {
+                CsvExporter::sync();
+            }
+            return;
+        }
+    }
+}
+
+void CsvExporter::write_batch(QVector<QByteArray>& batch, QByteArray& buffer) {
+    TRACE_SCOPE("csv.write", batch.size());
+    if (m_settings.fsync == FsyncPolicy::Always) {
+        for (const auto& row : batch) {
+            m_file.write(row);
+            m_file.flush();
+            CsvExporter::sync();
+        }
+    } else {
+        buffer.clear();
+        for (const auto& row : batch) {
+            buffer.append(row);
+        }
+        if (m_file.write(buffer) != buffer.size()) {
+            std::cerr << "Export could not be written: " << m_file.errorString().toStdString() << std::endl;
+        }
+        m_file.flush();
+        if (m_settings.fsync == FsyncPolicy::Batch) {
+            CsvExporter::sync();
+        }
+    }
+
+    m_rows_written.fetch_add(static_cast<quint64>(batch.size()), std::memory_order_relaxed);
+    m_flushes.fetch_add(1, std::memory_order_relaxed);
+    batch.clear();
+}
+
+void CsvExporter::sync() {
+    const int fd = m_file.handle();
+    if (fd >= 0) {
+        ::fsync(fd);
+    }
+}
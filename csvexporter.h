@@ -0,0 +1,88 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The csv-exporter keeps the export-file open for the whole measurement.
+ * Rows are only put into a ring-buffer by the event-loop-thread, a own
+ * writer-thread writes them in batches once enough rows are queued or
+ * the flush-interval is over. How often the data is synced to disk is
+ * set by the fsync-policy. On destruction all queued rows are written.
+ * Without text-mode the same writer is used for the binary history-log.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+class CsvExporter {
+
+public:
+    enum class FsyncPolicy {
+        Never,
+        Batch,
+        Always
+    };
+
+    struct Settings {
+        size_t capacity = 8192;
+        size_t flush_rows = 256;
+        int flush_interval_ms = 1000;
+        FsyncPolicy fsync = FsyncPolicy::Batch;
+        bool text_mode = true;
+    };
+
+    CsvExporter(const QString& filepath, const Settings& settings);
+    ~CsvExporter();
+    CsvExporter(const CsvExporter&) = delete;
+    CsvExporter& operator=(const CsvExporter&) = delete;
+
+    bool open();
+    void append(QByteArray row);
+    void close();
+
+    size_t queue_depth() const { return m_depth.load(std::memory_order_relaxed); }
+    quint64 rows_written() const { return m_rows_written.load(std::memory_order_relaxed); }
+    quint64 flushes() const { return m_flushes.load(std::memory_order_relaxed); }
+
+private:
+    QString m_filepath;
+    Settings m_settings;
+    QFile m_file;
+    std::thread m_writer;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_space;
+    QVector<QByteArray> m_ring;
+    size_t m_head = 0;
+    size_t m_count = 0;
+    bool m_stop = false;
+
+    std::atomic<size_t> m_depth{0};
+    std::atomic<quint64> m_rows_written{0};
+    std::atomic<quint64> m_flushes{0};
+
+    void run();
+    void write_batch(QVector<QByteArray>& batch, QByteArray& buffer);
+    void sync();
+};
+
+#endif // CSVEXPORTER_H
@@ -10,7 +10,7 @@
  *
  * Purpose of this file:
  * The display-class is responsible for a proper display of continues-
- * measurements. It gets its data from the appropriate a- or srv-signal
+ * measurements. It gets its data from the update-signal of every record-type
  * emited by the dns-tracker.
  * It is build to display the results of more then one dns-tracker-
  * objects.
@@ -20,233 +20,388 @@
 ********************************************************************/
 
 #include "display.h"
+#include "tracing.h"
+#include "convergence.h"
+#include "recordtraits.h"
 
 #include <iostream>
 
 #include <QHostAddress>
-#include <QTextStream>
+#include <QDateTime>
 #include <QDebug>
 
-Display::Display(const QString &start_time, const Options& opt, QObject *parent) :
-    QObject(parent), m_start_time(start_time), m_opt(opt) {}
+namespace {
 
-void Display::render_a_display() {
-    std::cout << "\033[2J\033[3J\033[H";
-    std::cout << "Measurement started at: " << m_start_time.toStdString() << std::endl;
+/*Rendering and export of the record-structs, the frame and the csv-row are written once over them*/
+const char* record_header(const QList<DnsARecord>&) {
+    return "Requested\tTarget";
+}
 
-    for (auto outer_it = m_a_occurance.cbegin(); outer_it != m_a_occurance.cend(); ++outer_it) {
-        const QString& server = outer_it.key();
-        const auto& by_hash = outer_it.value();
+const char* record_header(const QList<DnsSrvRecord>&) {
+    return "Requested\tTarget\tPriority\tTTL";
+}
 
-        std::cout << "@" << server.toStdString()
-                  << std::endl;
+const char* record_header(const QList<DnsMxRecord>&) {
+    return "Requested\tExchange\tPreference\tTTL";
+}
 
-        for (auto inner_it = by_hash.cbegin(); inner_it != by_hash.cend(); ++inner_it) {
-            const TimestampsARecord& occurance = inner_it.value();
+const char* record_header(const QList<DnsTxtRecord>&) {
+    return "Requested\tText\tTTL";
+}
 
-            std::cout << "\tFirst: " << occurance.first_occur.toStdString()
-                      << "\tLast: " << occurance.last_occur.toStdString()
-                      << std::endl;
+const char* record_header(const QList<DnsNameRecord>&) {
+    return "Requested\tTarget\tTTL";
+}
 
-            for (const auto& entry : occurance.record) {
-                if (m_opt.verbose) {
-                    std::cout << "Requested"
-                              << "\t"
-                              << "Target"
-                              << std::endl;
-                    std::cout << entry.name().toStdString() << "\t"
-                              << entry.value().toString().toStdString() << std::endl;
-                } else {
-                    std::cout << entry.value().toString().toStdString() << std::endl;
-                }
-            }
-            std::cout << std::endl;
-        }
+QString txt_text(const DnsTxtRecord& rec) {
+    QStringList parts;
+    for (const auto& value : rec.values) {
+        parts << QString::fromUtf8(value);
     }
+    return parts.join(' ');
 }
 
-void Display::render_single_a() {
-    std::cout << "\033[2J\033[3J\033[H";
-    std::cout << "Measurement started at: " << m_start_time.toStdString() << std::endl;
-    std::cout << "Time"
-              << "\t\t"
-              << "Requested"
-              << "\t"
-              << "Target"
-              << std::endl;
+std::string format_record(const DnsARecord& rec, bool verbose) {
+    if (verbose) {
+        return rec.name.toStdString() + "\t" + rec.value.toString().toStdString();
+    }
+    return rec.value.toString().toStdString();
+}
 
-    const auto& a_responses = m_a_responses;
-    for (const auto& response : a_responses) {
-        std::cout << "@" << response.server.toStdString();
-        if (response.hash_changed) {
-            std::cout << " (finished)";
-        }
-        std::cout << std::endl;
+std::string format_record(const DnsSrvRecord& rec, bool verbose) {
+    if (verbose) {
+        return rec.name.toStdString() + "\t" + rec.target.toStdString() + "\t"
+               + std::to_string(rec.priority) + "\t" + std::to_string(rec.ttl);
+    }
+    return rec.target.toStdString() + "\t" + std::to_string(rec.priority);
+}
 
-        std::cout << response.cur_timestamp.toStdString() << "\t";
-        const auto cur_a_record = response.cur_response;
-        for (const auto& cur_a : cur_a_record) {
-            std::cout << cur_a.name().toStdString() << "\t"
-                      << cur_a.value().toString().toStdString() << std::endl;
-        }
+std::string format_record(const DnsMxRecord& rec, bool verbose) {
+    if (verbose) {
+        return rec.name.toStdString() + "\t" + rec.exchange.toStdString() + "\t"
+               + std::to_string(rec.preference) + "\t" + std::to_string(rec.ttl);
     }
+    return rec.exchange.toStdString() + "\t" + std::to_string(rec.preference);
 }
 
-void Display::render_srv_display() {
-    std::cout << "\033[2J\033[3J\033[H";
-    std::cout << "Measurement started at: " << m_start_time.toStdString() << std::endl;
+std::string format_record(const DnsTxtRecord& rec, bool verbose) {
+    if (verbose) {
+        return rec.name.toStdString() + "\t" + txt_text(rec).toStdString() + "\t" + std::to_string(rec.ttl);
+    }
+    return txt_text(rec).toStdString();
+}
 
-    for (auto outer_it = m_srv_occurance.cbegin(); outer_it != m_srv_occurance.cend(); ++outer_it) {
-        const QString &server = outer_it.key();
-        const auto   &by_hash  = outer_it.value();
+std::string format_record(const DnsNameRecord& rec, bool verbose) {
+    if (verbose) {
+        return rec.name.toStdString() + "\t" + rec.value.toStdString() + "\t" + std::to_string(rec.ttl);
+    }
+    return rec.value.toStdString();
+}
 
-        std::cout << "@" << server.toStdString()
-                  << std::endl;
+QString csv_record(const DnsARecord& rec) {
+    return QString("\"%1(%2)\"").arg(rec.value.toString()).arg(rec.ttl);
+}
 
-        for (auto inner_it = by_hash.cbegin(); inner_it != by_hash.cend(); ++inner_it) {
-            const TimestampsSrvRecord& occurance = inner_it.value();
+QString csv_record(const DnsSrvRecord& rec) {
+    return QString("\"%1(%2, %3)\"").arg(rec.target).arg(rec.priority).arg(rec.ttl);
+}
 
-            std::cout << "\tFirst: " << occurance.first_occur.toStdString()
-                      << "\tLast: " << occurance.last_occur.toStdString()
-                      << std::endl;
+QString csv_record(const DnsMxRecord& rec) {
+    return QString("\"%1(%2, %3)\"").arg(rec.exchange).arg(rec.preference).arg(rec.ttl);
+}
 
-            if (m_opt.verbose) {
-                std::cout << "Requested"
-                          << "\t"
-                          << "Target"
-                          << "\t"
-                          << "Priority"
-                          << "\t"
-                          << "TTL"
-                          << std::endl;
-            }
-            for (const auto& entry : occurance.record) {
-                if (m_opt.verbose) {
-                    std::cout << entry.name().toStdString() << "\t"
-                              << entry.target().toStdString() << "\t"
-                              << entry.priority() << "\t"
-                              << entry.timeToLive() << std::endl;
-                } else {
-                    std::cout << entry.target().toStdString() << "\t"
-                              << entry.priority() << std::endl;
-                }
-            }
-        }
-        std::cout << std::endl;
-    }
-}
-
-void Display::render_single_srv() {
-    std::cout << "\033[2J\033[3J\033[H";
-    std::cout << "Measurement started at: " << m_start_time.toStdString() << std::endl;
-    std::cout << "Time"
-              << "\t\t"
-              << "Requested"
-              << "\t"
-              << "Target"
-              << "\t"
-              << "Priority"
-              << std::endl;
-
-    const auto& srv_responses = m_srv_responses;
-    for (const auto& response : srv_responses) {
-        std::cout << "@" << response.server.toStdString() << std::endl;
-
-        std::cout << response.cur_timestamp.toStdString() << std::endl;
-        const auto cur_srv_record = response.cur_response;
-        for (const auto& cur_srv : cur_srv_record) {
-            std::cout << "\t" << cur_srv.name().toStdString() << "\t"
-                      << cur_srv.target().toStdString() << "\t"
-                      << cur_srv.priority() << std::endl;
-        }
-    }
+//The text is free-form, quotes are doubled as usual in csv
+QString csv_record(const DnsTxtRecord& rec) {
+    QString text = txt_text(rec);
+    text.replace("\"", "\"\"");
+    return QString("\"%1(%2)\"").arg(text).arg(rec.ttl);
 }
 
-void Display::update_a_display(DnsADisplayData cur_data) {
-    auto& inner_map = m_a_occurance[cur_data.server];
+QString csv_record(const DnsNameRecord& rec) {
+    return QString("\"%1(%2)\"").arg(rec.value).arg(rec.ttl);
+}
 
-    if (inner_map.contains(cur_data.cur_hash)) {
-        inner_map[cur_data.cur_hash].record = cur_data.cur_response;
-        inner_map[cur_data.cur_hash].last_occur = cur_data.cur_timestamp;
-    } else {
-        inner_map[cur_data.cur_hash].first_occur = cur_data.cur_timestamp;
-        inner_map[cur_data.cur_hash].last_occur  = cur_data.cur_timestamp;
-        inner_map[cur_data.cur_hash].record     = cur_data.cur_response;
-        inner_map[cur_data.cur_hash].server     = cur_data.server;
-    }
+/*Stored records keep the TTLs of their first sighting, cached they count down together*/
+template <typename Record>
+Record with_current_ttl(const Record& rec, quint32 stored_ttl, quint32 current_ttl) {
+    Record current = rec;
+    current.ttl = rec.ttl - stored_ttl + current_ttl;
+    return current;
+}
+
+}
 
+Display::Display(qint64 start_time_ms, const Options& opt, QObject *parent) :
+    QObject(parent), m_start_time_ms(start_time_ms), m_opt(opt), m_latency(opt.rtt_window_ms) {
+    m_frame_timer.setSingleShot(true);
+    connect(&m_frame_timer, &QTimer::timeout, this, &Display::render_frame);
     if (m_opt.file_export) {
-        Display::write_a_to_csv(cur_data);
+        m_exporter = std::make_unique<CsvExporter>(m_opt.filepath, m_opt.export_settings);
+        m_exporter->open();
     }
-    Display::render_a_display();
+    if (m_opt.binary_export) {
+        m_history = std::make_unique<HistoryWriter>(m_opt.binary_filepath, m_opt.export_settings);
+        m_history->open();
+    }
+}
+
+Display::~Display() {
+    //Last state is shown even if the frame-timer did not fire anymore
+    Display::render_frame();
 }
 
-void Display::write_a_to_csv(DnsADisplayData cur_data) {
-    QFile file(m_opt.filepath);
-    if (!file.open(QIODevice::Append | QIODevice::Text)) {
-        std::cerr << "File could not be opended: " << m_opt.filepath.toStdString() << std::endl;
+/*Updates only mark the display dirty, the frame is drawn at most max_fps times per second*/
+void Display::schedule_render() {
+    m_dirty = true;
+    if (m_frame_timer.isActive()) {
         return;
     }
+    const qint64 frame_ms = 1000 / qMax(1, m_opt.max_fps);
+    const qint64 wait = m_frame_clock.isValid() ? qMax<qint64>(0, frame_ms - m_frame_clock.elapsed()) : 0;
+    m_frame_timer.start(static_cast<int>(wait));
+}
 
-    QStringList record_entry;
-    const auto data = cur_data.cur_response;
-    for (const auto& rec : data) {
-        record_entry << QString("\"%1(%2)\"").arg(rec.value().toString()).arg(rec.timeToLive());
+/*Only lines which differ from the last frame are rewritten, all in one write*/
+void Display::render_frame() {
+    if (!m_dirty) {
+        return;
+    }
+    TRACE_SCOPE("display.render", -1);
+    m_dirty = false;
+    m_frame_clock.start();
+
+    m_next_frame.clear();
+    m_next_frame.push_back("Measurement started at: " + Display::format_time(m_start_time_ms).toStdString());
+    Display::build_frame(m_next_frame);
+    Display::build_error_frame(m_next_frame);
+    if (m_opt.verbose) {
+        const RRsetStore::Stats stats = m_rrsets.stats();
+        m_next_frame.push_back("RRset-store: " + std::to_string(stats.rrsets) + " RRsets, "
+                               + std::to_string(m_occurance.size()) + " occurrences, "
+                               + std::to_string(stats.records) + " records, "
+                               + std::to_string((stats.bytes + 1023) / 1024) + " KiB");
     }
 
-    QStringList row = {
-        cur_data.cur_timestamp,
-        cur_data.server,
-        m_opt.dns_name,
-        record_entry.join(';')
-    };
+    std::string out;
+    if (m_screen.empty()) {
+        out += "\033[2J\033[3J\033[H";
+    }
+    for (size_t i = 0; i < m_next_frame.size(); ++i) {
+        if (i < m_screen.size() && m_screen[i] == m_next_frame[i]) {
+            continue;
+        }
+        out += "\033[" + std::to_string(i + 1) + ";1H";
+        out += m_next_frame[i];
+        out += "\033[K";
+    }
+    //Cursor stays below the frame, a shorter frame clears the rest of the old one
+    out += "\033[" + std::to_string(m_next_frame.size() + 1) + ";1H";
+    if (m_next_frame.size() < m_screen.size()) {
+        out += "\033[J";
+    }
+    m_screen.swap(m_next_frame);
 
-    QTextStream out(&file);
-    out << row.join(';') << '\n';
-    file.close();
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    std::cout.flush();
 }
 
+void Display::build_frame(std::vector<std::string>& lines) const {
+    for (const quint32 target_index : m_occurance.target_order()) {
+        const auto& target = m_occurance.target(target_index);
 
-void Display::update_srv_display(DnsSrvDisplayData cur_data) {
-    auto& inner_map = m_srv_occurance[cur_data.server];
+        lines.push_back("@" + target.server.toStdString() + " " + target.name.toStdString());
+        const std::string latency = Display::format_latency(target.server_id, target.target_id);
+        if (!latency.empty()) {
+            lines.push_back(latency);
+        }
 
-    if (inner_map.contains(cur_data.cur_hash)) {
-        inner_map[cur_data.cur_hash].record = cur_data.cur_response;
-        inner_map[cur_data.cur_hash].last_occur = cur_data.cur_timestamp;
-    } else {
-        inner_map[cur_data.cur_hash].first_occur = cur_data.cur_timestamp;
-        inner_map[cur_data.cur_hash].last_occur  = cur_data.cur_timestamp;
-        inner_map[cur_data.cur_hash].record     = cur_data.cur_response;
-        inner_map[cur_data.cur_hash].server     = cur_data.server;
+        for (const quint32 entry_index : target.entries) {
+            const Timestamps& occurance = m_occurance.entry(entry_index);
+
+            lines.push_back("\tFirst: " + Display::format_time(occurance.first_occur).toStdString()
+                            + "\tLast: " + Display::format_time(occurance.last_occur).toStdString());
+            if (occurance.refresh_ms >= 0) {
+                lines.push_back(Display::format_refresh(occurance));
+            }
+
+            const DnsRecordSet& stored = m_rrsets.records(occurance.hash);
+            const quint32 stored_ttl = min_ttl(stored);
+            std::visit([&](const auto& records) {
+                if (m_opt.verbose) {
+                    lines.push_back(record_header(records));
+                }
+                for (const auto& entry : records) {
+                    lines.push_back(format_record(with_current_ttl(entry, stored_ttl, occurance.ttl), m_opt.verbose));
+                }
+            }, stored);
+            lines.emplace_back();
+        }
     }
+}
 
-    if (m_opt.file_export) {
-        Display::write_srv_to_csv(cur_data);
+void Display::build_error_frame(std::vector<std::string>& lines) const {
+    for (const auto& failed : m_errors) {
+        lines.push_back("@" + failed.server.toStdString() + " " + failed.name.toStdString());
+        lines.push_back("\tErrors: " + std::to_string(failed.errors) + " (timeouts: " + std::to_string(failed.timeouts) + ")"
+                        + "\tLast: " + Display::format_time(failed.last_occur).toStdString()
+                        + " " + failed.last_error.toStdString());
+        lines.emplace_back();
     }
-    Display::render_srv_display();
 }
 
-void Display::write_srv_to_csv(DnsSrvDisplayData cur_data) {
-    QFile file(m_opt.filepath);
-    if (!file.open(QIODevice::Append | QIODevice::Text)) {
-        std::cerr << "File could not be opended: " << m_opt.filepath.toStdString() << std::endl;
+/*A failed lookup is counted per target and exported as a row without records*/
+void Display::record_error(const DnsDisplayData& cur_data) {
+    LookupErrors& failed = m_errors[(static_cast<quint64>(cur_data.server_id) << 32) | cur_data.target_id];
+    if (failed.errors == 0) {
+        failed.server = cur_data.server;
+        failed.name = cur_data.name;
+    }
+    ++failed.errors;
+    if (cur_data.timeout) {
+        ++failed.timeouts;
+    }
+    failed.last_occur = cur_data.cur_time_ms;
+    failed.last_error = cur_data.error_string;
+    m_now_ms = qMax(m_now_ms, cur_data.cur_time_ms);
+
+    if (m_exporter) {
+        QStringList row = {
+            Display::format_time(cur_data.cur_time_ms),
+            cur_data.server,
+            cur_data.name,
+            Display::latency_columns(cur_data.server_id, cur_data.target_id, cur_data.rtt_us).join(';'),
+            QString(),
+            QString(),
+            QString("\"ERROR: %1\"").arg(cur_data.error_string)
+        };
+        m_exporter->append((row.join(';') + '\n').toUtf8());
+    }
+    Display::schedule_render();
+}
+
+void Display::update_display(const DnsDisplayData& cur_data) {
+    TRACE_SCOPE("display.update", cur_data.target_id);
+    if (cur_data.error != QDnsLookup::NoError) {
+        Display::record_error(cur_data);
+        if (m_history) {
+            m_history->record(cur_data);
+        }
         return;
     }
 
+    //One probe of the flat table, records are only stored for a hash seen the first time
+    bool inserted = false;
+    Timestamps& occurance = m_occurance.touch(cur_data.server_id, cur_data.target_id, cur_data.cur_hash,
+                                              cur_data.server, cur_data.name, inserted);
+    if (inserted) {
+        occurance.first_occur = cur_data.cur_time_ms;
+        occurance.refresh_ms = cur_data.refresh_ms;
+        occurance.refresh_error_ms = cur_data.refresh_error_ms;
+        occurance.propagation_ms = cur_data.propagation_ms;
+        m_rrsets.intern(cur_data.cur_hash, cur_data.cur_response);
+    }
+    occurance.last_occur = cur_data.cur_time_ms;
+    m_now_ms = qMax(m_now_ms, cur_data.cur_time_ms);
+    occurance.ttl = cur_data.ttl;
+    if (m_convergence) {
+        m_convergence->update(cur_data);
+    }
+
+    if (m_exporter) {
+        Display::write_to_csv(cur_data);
+    }
+    if (m_history) {
+        m_history->record(cur_data);
+    }
+    Display::schedule_render();
+}
+
+/*Every record with its own TTL, from the answer of the lookup if the event carries it*/
+void Display::write_to_csv(const DnsDisplayData& cur_data) {
+    TRACE_SCOPE("csv.row", cur_data.target_id);
     QStringList record_entry;
-    const auto& data = cur_data.cur_response;
-    for (const auto& rec : data) {
-        record_entry << QString("\"%1(%2, %3)\"").arg(rec.target()).arg(rec.priority()).arg(rec.timeToLive());
+    if (record_count(cur_data.cur_response) > 0) {
+        std::visit([&](const auto& list) {
+            for (const auto& rec : list) {
+                record_entry << csv_record(rec);
+            }
+        }, cur_data.cur_response);
+    } else {
+        const DnsRecordSet& stored = m_rrsets.records(cur_data.cur_hash);
+        const quint32 stored_ttl = min_ttl(stored);
+        std::visit([&](const auto& list) {
+            for (const auto& rec : list) {
+                record_entry << csv_record(with_current_ttl(rec, stored_ttl, cur_data.ttl));
+            }
+        }, stored);
     }
 
     QStringList row = {
-        cur_data.cur_timestamp,
+        Display::format_time(cur_data.cur_time_ms),
         cur_data.server,
-        m_opt.dns_name,
+        cur_data.name,
+        Display::latency_columns(cur_data.server_id, cur_data.target_id, cur_data.rtt_us).join(';'),
+        cur_data.propagation_ms >= 0 ? QString::number(cur_data.propagation_ms) : QString(),
+        cur_data.propagation_ms >= 0 ? QString::number(cur_data.refresh_error_ms) : QString(),
         record_entry.join(';')
     };
 
-    QTextStream out (&file);
-    out << row.join(';') << "\n";
-    file.close();
+    m_exporter->append((row.join(';') + '\n').toUtf8());
+}
+
+/*ISO-format has a resolution of seconds, so rows and frames of the same second share one string*/
+const QString& Display::format_time(qint64 time_ms) const {
+    const qint64 second = time_ms / 1000;
+    if (second != m_format_second) {
+        m_format_second = second;
+        m_format_cache = QDateTime::fromMSecsSinceEpoch(second * 1000).toString(Qt::ISODate);
+    }
+    return m_format_cache;
+}
+
+static std::string format_ms(qint64 value_us) {
+    return QString::number(static_cast<double>(value_us) / 1000.0, 'f', 1).toStdString() + "ms";
+}
+
+/*Refresh of the resolver estimated from the TTL, propagation counted from the start of the measurement*/
+std::string Display::format_refresh(const Timestamps& occurance) const {
+    const qint64 propagation_s = occurance.propagation_ms / 1000;
+    const QString propagation = QString("%1:%2:%3.%4")
+                                    .arg(propagation_s / 3600, 2, 10, QChar('0'))
+                                    .arg((propagation_s / 60) % 60, 2, 10, QChar('0'))
+                                    .arg(propagation_s % 60, 2, 10, QChar('0'))
+                                    .arg((occurance.propagation_ms % 1000) / 100);
+    const std::string error = "+/-" + QString::number(static_cast<double>(occurance.refresh_error_ms) / 1000.0, 'f', 1).toStdString() + "s";
+    return "\tRefreshed: " + QDateTime::fromMSecsSinceEpoch(occurance.refresh_ms).toString(Qt::ISODate).toStdString() + " " + error
+           + "\tPropagation: " + propagation.toStdString() + " " + error;
+}
+
+std::string Display::format_latency(quint32 server_id, quint32 target_id) const {
+    const LatencyHistogram* histogram = m_latency.find(server_id, target_id);
+    if (!histogram) {
+        return std::string();
+    }
+    const LatencyHistogram::Summary rtt = histogram->summary(m_now_ms);
+    if (rtt.count == 0) {
+        return std::string();
+    }
+    return "\tRTT p50: " + format_ms(rtt.p50_us)
+           + "\tp99: " + format_ms(rtt.p99_us)
+           + "\tp999: " + format_ms(rtt.p999_us)
+           + "\tmax: " + format_ms(rtt.max_us)
+           + "\t(" + std::to_string(rtt.count) + " lookups)";
+}
+
+/*RTT of this lookup and the percentiles of the target in microseconds, empty columns if nothing was measured*/
+QStringList Display::latency_columns(quint32 server_id, quint32 target_id, qint64 rtt_us) const {
+    QStringList columns = {rtt_us >= 0 ? QString::number(rtt_us) : QString()};
+    const LatencyHistogram* histogram = m_latency.find(server_id, target_id);
+    const LatencyHistogram::Summary rtt = histogram ? histogram->summary(m_now_ms) : LatencyHistogram::Summary();
+    if (rtt.count == 0) {
+        columns << QString() << QString() << QString() << QString();
+    } else {
+        columns << QString::number(rtt.p50_us) << QString::number(rtt.p99_us)
+                << QString::number(rtt.p999_us) << QString::number(rtt.max_us);
+    }
+    return columns;
 }
@@ -10,7 +10,7 @@
  *
  * Purpose of this file:
  * The display-class is responsible for a proper display of continues-
- * measurements. It gets its data from the appropriate a- or srv-signal
+ * measurements. It gets its data from the update-signal of every record-type
  * emited by the dns-tracker.
  * It is build to display the results of more then one dns-tracker-
  * objects.
@@ -25,49 +25,101 @@
 
 #include <QCoreApplication>
 #include <QDnsLookup>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <QMap>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "dnstracker.h"
+#include "csvexporter.h"
+#include "historylog.h"
+#include "rrsetstore.h"
+#include "occurrencetable.h"
+#include "latencyhistogram.h"
 
-struct TimestampsARecord {
-    QList<QDnsHostAddressRecord> record;
-    QString server;
-    QString first_occur = "";
-    QString last_occur = "";
+class Convergence;
+
+struct Timestamps {
+    QByteArray hash;
+    quint32 ttl = 0;
+    qint64 first_occur = 0;
+    qint64 last_occur = 0;
+    qint64 refresh_ms = -1;
+    qint64 refresh_error_ms = 0;
+    qint64 propagation_ms = -1;
 };
 
-struct TimestampsSrvRecord {
-    QList<QDnsServiceRecord> record;
+struct LookupErrors {
     QString server;
-    QString first_occur = "";
-    QString last_occur = "";
+    QString name;
+    quint64 errors = 0;
+    quint64 timeouts = 0;
+    qint64 last_occur = 0;
+    QString last_error;
 };
 
 class Display : public QObject {
     Q_OBJECT
+    friend struct DisplayBenchAccess;
 
 public:
-    Display(const QString& start_time, const Options& opt, QObject *parent = nullptr);
+    Display(qint64 start_time_ms, const Options& opt, QObject *parent = nullptr);
+    ~Display();
+
+    LatencyRegistry* latency() { return &m_latency; }
+    const LatencyRegistry* latency() const { return &m_latency; }
+    size_t export_queue_depth() const { return m_exporter ? m_exporter->queue_depth() : 0; }
+    size_t history_queue_depth() const { return m_history ? m_history->queue_depth() : 0; }
+    //Growth of the occurrence-table and the shared RRsets, reported by the simulation
+    size_t occurrence_count() const { return m_occurance.size(); }
+    RRsetStore::Stats rrset_stats() const { return m_rrsets.stats(); }
+    //Fed with every answer, owned by the caller
+    void attach_convergence(Convergence* convergence) { m_convergence = convergence; }
 
 public slots:
-    void update_a_display(DnsADisplayData cur_data);
-    void update_srv_display(DnsSrvDisplayData cur_data);
+    void update_display(const DnsDisplayData& cur_data);
 
 private:
-    QString m_start_time;
+    qint64 m_start_time_ms;
+    //Times are kept as epoch-ms and only formatted for a frame or an export-row
+    mutable qint64 m_format_second = -1;
+    mutable QString m_format_cache;
     Options m_opt;
-    QMap<QString, DnsADisplayData> m_a_responses;
-    QMap<QString, DnsSrvDisplayData> m_srv_responses;
-
-    QMap<QString, QMap<QByteArray, TimestampsARecord>> m_a_occurance;
-    QMap<QString, QMap<QByteArray, TimestampsSrvRecord>> m_srv_occurance;
-
-    void render_a_display();
-    void render_srv_display();
-    void render_single_a();
-    void render_single_srv();
-    void write_a_to_csv(DnsADisplayData cur_data);
-    void write_srv_to_csv(DnsSrvDisplayData cur_data);
+    std::unique_ptr<CsvExporter> m_exporter;
+    std::unique_ptr<HistoryWriter> m_history;
+
+    //Records of every occurance, shared by all servers and targets with the same answer
+    RRsetStore m_rrsets;
+    //RTT-histograms per (server id, target id), recorded by the trackers
+    LatencyRegistry m_latency;
+    qint64 m_now_ms = 0;
+
+    //Keyed by (server id, target id, hash), so one display can hold several targets per server
+    OccurrenceTable<Timestamps> m_occurance;
+    //Failed lookups by (server id << 32 | target id), they have no hash to be keyed by
+    QMap<quint64, LookupErrors> m_errors;
+    Convergence* m_convergence = nullptr;
+
+    //Differential renderer: last drawn frame, dirty-flag and frame-rate cap
+    std::vector<std::string> m_screen;
+    std::vector<std::string> m_next_frame;
+    bool m_dirty = false;
+    QTimer m_frame_timer;
+    QElapsedTimer m_frame_clock;
+
+    void schedule_render();
+    void render_frame();
+    void build_frame(std::vector<std::string>& lines) const;
+    void build_error_frame(std::vector<std::string>& lines) const;
+    void record_error(const DnsDisplayData& cur_data);
+    void write_to_csv(const DnsDisplayData& cur_data);
+    const QString& format_time(qint64 time_ms) const;
+    std::string format_latency(quint32 server_id, quint32 target_id) const;
+    std::string format_refresh(const Timestamps& occurance) const;
+    QStringList latency_columns(quint32 server_id, quint32 target_id, qint64 rtt_us) const;
 
 };
 
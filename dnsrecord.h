@@ -0,0 +1,82 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Plain record-structs used through the whole pipeline (tracker, hashing,
+ * display). The Qt-record-classes can only be filled by QDnsLookup itself,
+ * so both lookup-backends (QDnsLookup and the native wire-format engine)
+ * translate their answers into these structs.
+ * Record-types with the same rdata share one struct (A/AAAA, CNAME/NS).
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef DNSRECORD_H
+#define DNSRECORD_H
+
+#include <variant>
+
+#include <QByteArray>
+#include <QDnsLookup>
+#include <QHostAddress>
+#include <QList>
+#include <QString>
+
+//A and AAAA
+struct DnsARecord {
+    QString name;
+    QHostAddress value;
+    quint32 ttl = 0;
+};
+
+struct DnsSrvRecord {
+    QString name;
+    QString target;
+    quint16 priority = 0;
+    quint16 weight = 0;
+    quint16 port = 0;
+    quint32 ttl = 0;
+};
+
+struct DnsMxRecord {
+    QString name;
+    QString exchange;
+    quint16 preference = 0;
+    quint32 ttl = 0;
+};
+
+struct DnsTxtRecord {
+    QString name;
+    QList<QByteArray> values;
+    quint32 ttl = 0;
+};
+
+//CNAME and NS, the value is a domain-name
+struct DnsNameRecord {
+    QString name;
+    QString value;
+    quint32 ttl = 0;
+};
+
+/*Records of one answer, the alternative is fixed by the record-type of the lookup*/
+using DnsRecordSet = std::variant<QList<DnsARecord>, QList<DnsSrvRecord>, QList<DnsMxRecord>,
+                                  QList<DnsTxtRecord>, QList<DnsNameRecord>>;
+
+struct DnsLookupResult {
+    QDnsLookup::Error error = QDnsLookup::NoError;
+    QString error_string;
+    //No answer within the timeout, error is ResolverError then
+    bool timeout = false;
+    //Raw answer equal to the previous one of the query, the records (and so the hash) are unchanged
+    bool unchanged = false;
+    DnsRecordSet records;
+};
+
+#endif // DNSRECORD_H
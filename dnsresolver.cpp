@@ -0,0 +1,295 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the native lookup-backend. Message-ids are taken
+ * from a random start and then counted up, the id-table maps every id
+ * directly to the registered query, so a reply is matched in O(1).
+ * Replies from other sources, with unknown ids or a different question
+ * are dropped silently.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "dnsresolver.h"
+#include "dnswire.h"
+#include "tracing.h"
+
+#include <iostream>
+
+#include <QRandomGenerator>
+#include <QSocketNotifier>
+
+namespace {
+constexpr qsizetype RECV_BUFFER_SIZE = 65535;
+constexpr int ID_SPACE = 65536;
+}
+
+DnsResolver::DnsResolver(const QHostAddress& server, quint16 port, QObject *parent)
+    : QObject(parent), m_server(server), m_port(port), m_socket(this), m_timeout_timer(this), m_flush_timer(this),
+      m_id_table(ID_SPACE, INVALID_HANDLE) {
+    m_next_id = static_cast<quint16>(QRandomGenerator::global()->bounded(ID_SPACE));
+    m_recv_buffer.resize(RECV_BUFFER_SIZE);
+    m_clock.start();
+
+    QObject::connect(&m_socket, &QUdpSocket::readyRead, this, &DnsResolver::read_pending);
+    QObject::connect(&m_timeout_timer, &QTimer::timeout, this, &DnsResolver::expire_queries);
+    m_timeout_timer.setInterval(1000);
+
+    //Zero-timer: fires once the current event-loop-pass (e.g. a scheduler-tick) has queued everything
+    m_flush_timer.setSingleShot(true);
+    m_flush_timer.setInterval(0);
+    QObject::connect(&m_flush_timer, &QTimer::timeout, this, &DnsResolver::flush_batch);
+}
+
+DnsResolver::~DnsResolver() = default;
+
+bool DnsResolver::enable_batching(BatchSocket::Mode mode, bool print_stats) {
+    if (!BatchSocket::is_supported(BatchSocket::Mode::Mmsg)) {
+        std::cerr << "Batched I/O is not supported on this platform, using single datagrams" << std::endl;
+        return false;
+    }
+    auto batch = std::make_unique<BatchSocket>();
+    if (!batch->open(m_server, m_port, mode)) {
+        return false;
+    }
+
+    m_batch = std::move(batch);
+    m_print_stats = print_stats;
+    m_notifier = new QSocketNotifier(m_batch->fd(), QSocketNotifier::Read, this);
+    QObject::connect(m_notifier, &QSocketNotifier::activated, this, &DnsResolver::read_batch);
+    m_timeout_timer.start();
+    return true;
+}
+
+/*The expiry-check runs four times per timeout, so a query is failed at most a quarter too late*/
+void DnsResolver::set_timeout(int timeout_ms) {
+    m_timeout_ms = qMax(1, timeout_ms);
+    m_timeout_timer.setInterval(qBound(10, m_timeout_ms / 4, 1000));
+}
+
+bool DnsResolver::open() {
+    if (m_batch) {
+        return true;
+    }
+    if (m_socket.state() == QAbstractSocket::BoundState) {
+        return true;
+    }
+    const QHostAddress local = m_server.protocol() == QHostAddress::IPv6Protocol
+                                   ? QHostAddress(QHostAddress::AnyIPv6)
+                                   : QHostAddress(QHostAddress::AnyIPv4);
+    if (!m_socket.bind(local, 0)) {
+        std::cerr << "Socket for DNS-server " << m_server.toString().toStdString()
+                  << " could not be opened: " << m_socket.errorString().toStdString() << std::endl;
+        return false;
+    }
+    m_timeout_timer.start();
+    return true;
+}
+
+quint32 DnsResolver::add_query(const QString& name, QDnsLookup::Type type, ResultHandler handler) {
+    const DnsWire::Decoder decoder = DnsWire::decoder(type);
+    if (!decoder) {
+        return INVALID_HANDLE;
+    }
+    const auto key = qMakePair(name.toLower(), static_cast<int>(type));
+    auto cached = m_packet_cache.find(key);
+    if (cached == m_packet_cache.end()) {
+        QByteArray packet = DnsWire::encode_query(name, static_cast<quint16>(type));
+        if (packet.isEmpty()) {
+            return INVALID_HANDLE;
+        }
+        cached = m_packet_cache.insert(key, packet);
+    }
+
+    Query query;
+    query.packet = cached.value();
+    query.decoder = decoder;
+    query.type = static_cast<quint16>(type);
+    query.handler = std::move(handler);
+    m_queries.append(query);
+    return static_cast<quint32>(m_queries.size() - 1);
+}
+
+bool DnsResolver::send(quint32 handle) {
+    if (handle >= static_cast<quint32>(m_queries.size()) || !DnsResolver::open()) {
+        return false;
+    }
+    Query& query = m_queries[handle];
+    if (query.in_flight) {
+        DnsResolver::release(query);
+    }
+
+    quint16 id = 0;
+    if (!DnsResolver::allocate_id(handle, id)) {
+        return false;
+    }
+
+    m_send_buffer.resize(query.packet.size());
+    std::memcpy(m_send_buffer.data(), query.packet.constData(), query.packet.size());
+    DnsWire::write_message_id(m_send_buffer.data(), id);
+
+    if (m_batch) {
+        if (!m_batch->queue(m_send_buffer.constData(), m_send_buffer.size())) {
+            m_id_table[id] = INVALID_HANDLE;
+            return false;
+        }
+        if (!m_flush_timer.isActive()) {
+            m_flush_timer.start();
+        }
+    } else if (m_socket.writeDatagram(m_send_buffer.constData(), m_send_buffer.size(), m_server, m_port) < 0) {
+        m_id_table[id] = INVALID_HANDLE;
+        return false;
+    }
+
+    query.id = id;
+    query.in_flight = true;
+    query.sent_at = m_clock.elapsed();
+    ++m_in_flight;
+    ++m_queries_sent;
+    return true;
+}
+
+void DnsResolver::read_pending() {
+    QHostAddress sender;
+    quint16 sender_port = 0;
+
+    while (m_socket.hasPendingDatagrams()) {
+        const qint64 size = m_socket.readDatagram(m_recv_buffer.data(), m_recv_buffer.size(), &sender, &sender_port);
+        if (sender_port != m_port || sender != m_server) {
+            continue;
+        }
+        DnsResolver::process_datagram(m_recv_buffer.constData(), size);
+    }
+}
+
+void DnsResolver::flush_batch() {
+    if (!m_batch) {
+        return;
+    }
+    const BatchSocket::BatchInfo info = m_batch->flush();
+    if (m_print_stats && info.messages > 0) {
+        std::cerr << "[io] " << m_server.toString().toStdString()
+                  << " send-batch: " << info.messages << " queries, "
+                  << info.syscalls << " syscalls" << std::endl;
+    }
+}
+
+void DnsResolver::read_batch() {
+    int messages = 0;
+    int syscalls = 0;
+    while (true) {
+        const BatchSocket::BatchInfo info = m_batch->receive();
+        syscalls += info.syscalls;
+        messages += info.messages;
+        for (int i = 0; i < info.messages; ++i) {
+            DnsResolver::process_datagram(m_batch->datagram(i), m_batch->datagram_size(i));
+        }
+        if (info.messages < BatchSocket::MAX_BATCH) {
+            break;
+        }
+    }
+    if (m_print_stats && messages > 0) {
+        std::cerr << "[io] " << m_server.toString().toStdString()
+                  << " receive-batch: " << messages << " replies, "
+                  << syscalls << " syscalls" << std::endl;
+    }
+}
+
+void DnsResolver::process_datagram(const char* data, qsizetype size) {
+    TRACE_SCOPE("resolver.decode", size);
+    if (size < DnsWire::HEADER_SIZE) {
+        return;
+    }
+
+    const quint16 id = DnsWire::read_message_id(data);
+    const quint32 handle = m_id_table[id];
+    if (handle == INVALID_HANDLE) {
+        return;
+    }
+    Query& query = m_queries[handle];
+    if (!DnsWire::question_matches(data, size, query.packet)) {
+        return;
+    }
+
+    ++m_replies_received;
+    DnsResolver::release(query);
+
+    //Steady state: the same bytes as the last reply, only message-id and TTLs differ
+    if (!query.last_reply.isEmpty()
+        && DnsWire::reuse_answer(data, size, query.last_reply, query.type, query.last_result.records)) {
+        ++m_replies_reused;
+        //Moved out for the handler, it may register new queries and move the vector
+        m_result = std::move(query.last_result);
+        DnsResolver::complete(handle, m_result);
+        m_queries[handle].last_result = std::move(m_result);
+        return;
+    }
+
+    m_result.unchanged = false;
+    query.decoder(data, size, m_result);
+    if (m_result.error == QDnsLookup::NoError) {
+        query.last_reply = QByteArray(data, size);
+        query.last_result = m_result;
+        query.last_result.unchanged = true;
+    } else {
+        query.last_reply.clear();
+    }
+    DnsResolver::complete(handle, m_result);
+}
+
+void DnsResolver::expire_queries() {
+    if (m_in_flight == 0) {
+        return;
+    }
+    const qint64 now = m_clock.elapsed();
+    DnsLookupResult timeout;
+    timeout.error = QDnsLookup::ResolverError;
+    timeout.error_string = "Request timed out";
+    timeout.timeout = true;
+
+    for (quint32 handle = 0; handle < static_cast<quint32>(m_queries.size()); ++handle) {
+        Query& query = m_queries[handle];
+        if (query.in_flight && now - query.sent_at >= m_timeout_ms) {
+            DnsResolver::release(query);
+            DnsResolver::complete(handle, timeout);
+        }
+    }
+}
+
+bool DnsResolver::allocate_id(quint32 handle, quint16& id) {
+    for (int attempt = 0; attempt < ID_SPACE; ++attempt) {
+        const quint16 candidate = m_next_id++;
+        if (m_id_table[candidate] == INVALID_HANDLE) {
+            m_id_table[candidate] = handle;
+            id = candidate;
+            return true;
+        }
+    }
+    std::cerr << "No free message-id for DNS-server " << m_server.toString().toStdString() << std::endl;
+    return false;
+}
+
+void DnsResolver::release(Query& query) {
+    if (!query.in_flight) {
+        return;
+    }
+    m_id_table[query.id] = INVALID_HANDLE;
+    query.in_flight = false;
+    --m_in_flight;
+}
+
+void DnsResolver::complete(quint32 handle, const DnsLookupResult& result) {
+    //Copy the handler, it may register new queries and move the vector
+    ResultHandler handler = m_queries[handle].handler;
+    if (handler) {
+        handler(result);
+    }
+}
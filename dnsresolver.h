@@ -0,0 +1,118 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The dns-resolver-class is the native lookup-backend. There is one
+ * object per DNS-server, it holds one UDP-socket and multiplexes all
+ * queries of all trackers for this server by the DNS-message-id.
+ * Every (name, type) is encoded only once when the tracker registers,
+ * per poll only the message-id is patched into a reused send-buffer.
+ * With batching enabled the queries of one event-loop-pass are collected
+ * and sent by the batch-socket in one go.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef DNSRESOLVER_H
+#define DNSRESOLVER_H
+
+#include <functional>
+#include <memory>
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+#include "dnsrecord.h"
+#include "dnswire.h"
+#include "batchsocket.h"
+
+class QSocketNotifier;
+
+class DnsResolver : public QObject {
+    Q_OBJECT
+
+public:
+    using ResultHandler = std::function<void(const DnsLookupResult&)>;
+    static constexpr quint32 INVALID_HANDLE = 0xFFFFFFFF;
+
+    DnsResolver(const QHostAddress& server, quint16 port = 53, QObject *parent = nullptr);
+
+    ~DnsResolver();
+
+    bool enable_batching(BatchSocket::Mode mode, bool print_stats);
+    bool open();
+    quint32 add_query(const QString& name, QDnsLookup::Type type, ResultHandler handler);
+    bool send(quint32 handle);
+
+    void set_timeout(int timeout_ms);
+    size_t in_flight() const { return m_in_flight; }
+    quint64 queries_sent() const { return m_queries_sent; }
+    quint64 replies_received() const { return m_replies_received; }
+    //Replies equal to the previous one of their query, neither decoded nor hashed again
+    quint64 replies_reused() const { return m_replies_reused; }
+
+private slots:
+    void read_pending();
+    void expire_queries();
+    void flush_batch();
+    void read_batch();
+
+private:
+    struct Query {
+        QByteArray packet;
+        //Chosen once for the record-type of the query
+        DnsWire::Decoder decoder = nullptr;
+        quint16 type = 0;
+        //Last successfully decoded reply and its result, compared with the next one
+        QByteArray last_reply;
+        DnsLookupResult last_result;
+        ResultHandler handler;
+        quint16 id = 0;
+        bool in_flight = false;
+        qint64 sent_at = 0;
+    };
+
+    QHostAddress m_server;
+    quint16 m_port;
+    QUdpSocket m_socket;
+    QTimer m_timeout_timer;
+    QTimer m_flush_timer;
+    std::unique_ptr<BatchSocket> m_batch;
+    QSocketNotifier* m_notifier = nullptr;
+    bool m_print_stats = false;
+    QElapsedTimer m_clock;
+    int m_timeout_ms = 5000;
+
+    QVector<Query> m_queries;
+    QVector<quint32> m_id_table;
+    QHash<QPair<QString, int>, QByteArray> m_packet_cache;
+    quint16 m_next_id = 0;
+    size_t m_in_flight = 0;
+    quint64 m_queries_sent = 0;
+    quint64 m_replies_received = 0;
+    quint64 m_replies_reused = 0;
+
+    QByteArray m_send_buffer;
+    QByteArray m_recv_buffer;
+    DnsLookupResult m_result;
+
+    void process_datagram(const char* data, qsizetype size);
+    bool allocate_id(quint32 handle, quint16& id);
+    void release(Query& query);
+    void complete(quint32 handle, const DnsLookupResult& result);
+};
+
+#endif // DNSRESOLVER_H
@@ -12,43 +12,144 @@
  * The dns-tracker-class defines an the tracking-object. It is resposible
  * for running the lookup regarding to the settings it is instantiiated with.
  * Only for continue-mode it will sent every 60 seconds (SLEEP_INTERVALL) a new
- * DNS-request to the server set at the beginning.
- * Continues-Mode is activ until STRG+C, time-measurement is currently not
- * active, but still remain in code for future usage.
+ * DNS-request to the server set at the beginning. If a scheduler is attached
+ * the next request is armed at the shared scheduler instead of an own timer.
+ * The lookup itself is either done by QDnsLookup or by the native
+ * dns-resolver-backend, both deliver the same DnsLookupResult. In a
+ * simulation the answer-script delivers it at once, in virtual time.
+ * Continues-Mode is activ until STRG+C, or with the convergence-monitor
+ * until the target has converged. After a change the refresh of the
+ * resolver is estimated from the TTL-countdown of the new answer.
  *
  * Author: Dennis Kuehnlein (2025)
 ********************************************************************/
 
 #include "dnstracker.h"
 #include "hashing.h"
+#include "recordtraits.h"
+#include "scheduler.h"
+#include "dnsresolver.h"
+#include "latencyhistogram.h"
+#include "metricsserver.h"
+#include "ratelimiter.h"
+#include "clock.h"
+#include "answerscript.h"
+#include "tracing.h"
 
 #include <iostream>
 
 #include <QHostAddress>
 #include <QTimer>
 #include <QDebug>
-#include <QDateTime>
+#include <QPointer>
 
 DnsTracker::DnsTracker(const Options& options, QObject *parent)
-    : QObject(parent), m_options(options) {}
+    : QObject(parent), m_lookup_timeout(this), m_options(options) {
+    m_lookup_timeout.setSingleShot(true);
+    QObject::connect(&m_lookup_timeout, &QTimer::timeout, this, &DnsTracker::expire_qt_lookup);
+    dispatch_record_type(m_options.record_type, [this](auto traits) {
+        m_read_qt = &DnsTracker::read_records<decltype(traits)>;
+    });
+}
+
+void DnsTracker::attach_scheduler(Scheduler* scheduler) {
+    m_scheduler = scheduler;
+    m_schedule_id = scheduler->add_target(this);
+}
+
+void DnsTracker::attach_latency(LatencyHistogram* histogram) {
+    m_latency = histogram;
+}
+
+void DnsTracker::attach_metrics(TargetMetrics* metrics) {
+    m_metrics = metrics;
+}
+
+void DnsTracker::attach_limiter(RateLimiter* limiter) {
+    m_limiter = limiter;
+}
+
+void DnsTracker::attach_answers(const AnswerScript* answers) {
+    m_answers = answers;
+}
+
+bool DnsTracker::attach_resolver(DnsResolver* resolver) {
+    QPointer<DnsTracker> self(this);
+    m_query_handle = resolver->add_query(m_options.dns_name, m_options.record_type, [self](const DnsLookupResult& result) {
+        if (self) {
+            self->handle_result(result);
+        }
+    });
+    if (m_query_handle == DnsResolver::INVALID_HANDLE) {
+        std::cerr << "Invalid DNS-name: " << m_options.dns_name.toStdString() << std::endl;
+        return false;
+    }
+    m_resolver = resolver;
+    return true;
+}
 
 void DnsTracker::start() {
     if (m_options.continue_measurment) {
-        m_start_time = QDateTime::currentMSecsSinceEpoch();
+        m_start_time = DnsTracker::current_time_ms();
+        if (m_scheduler) {
+            m_scheduler->schedule_with_jitter(m_schedule_id, static_cast<qint64>(m_options.start_spread));
+            return;
+        }
     }
     DnsTracker::run_lookup();
 
 }
 
+void DnsTracker::poll() {
+    DnsTracker::run_lookup();
+}
+
 void DnsTracker::run_lookup() {
+    TRACE_SCOPE("lookup.send", m_options.target_id);
+    if (m_stopped) {
+        return;
+    }
+    //Rate and queries in flight are limited per server, a throttled lookup is only delayed
+    if (m_limiter && !m_holds_slot) {
+        const qint64 wait_ms = m_limiter->acquire();
+        if (wait_ms > 0) {
+            if (m_metrics) {
+                m_metrics->throttled.fetch_add(1, std::memory_order_relaxed);
+            }
+            DnsTracker::schedule_lookup(wait_ms);
+            return;
+        }
+        m_holds_slot = true;
+    }
+
+    m_rtt_clock.start();
+    if (m_queries_sent++ == 0) {
+        m_first_query_ms = DnsTracker::current_time_ms();
+    }
+    if (m_metrics) {
+        m_metrics->queries_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (m_answers) {
+        DnsTracker::handle_result(m_answers->lookup(m_options.dns_name, m_options.record_type, DnsTracker::current_time_ms(),
+                                                    static_cast<int>(m_options.server_id)));
+        return;
+    }
+    if (m_resolver) {
+        if (!m_resolver->send(m_query_handle)) {
+            DnsLookupResult result;
+            result.error = QDnsLookup::ResolverError;
+            result.error_string = "Request could not be sent";
+            DnsTracker::handle_result(result);
+        }
+        return;
+    }
+
     if (m_dns) {
         m_dns->deleteLater();
     }
 
-    if (m_options.dns_type.toUpper() == "SRV") {
-        m_dns = new QDnsLookup(QDnsLookup::Type(QDnsLookup::SRV), m_options.dns_name, this);
-    } else if (m_options.dns_type.toUpper() == "A") {
-        m_dns = new QDnsLookup(QDnsLookup::Type(QDnsLookup::A), m_options.dns_name, this);
+    if (m_read_qt) {
+        m_dns = new QDnsLookup(m_options.record_type, m_options.dns_name, this);
     } else {
         std::cerr << "DNS-Type "
                   << m_options.dns_type.toStdString()
@@ -60,136 +161,303 @@ void DnsTracker::run_lookup() {
     }
 
     m_dns->setNameserver(QHostAddress(m_options.dns_server));
-    if (m_options.continue_measurment) {
-        QObject::connect(m_dns, &QDnsLookup::finished, this, &DnsTracker::start_tracking);
-    } else {
-        QObject::connect(m_dns, &QDnsLookup::finished, this, &DnsTracker::display_single_lookup);
-    }
+    QObject::connect(m_dns, &QDnsLookup::finished, this, &DnsTracker::read_qt_lookup);
     m_dns->lookup();
+    m_lookup_timeout.start(m_options.timeout_ms);
 }
 
-void DnsTracker::display_single_lookup() {
+/*QDnsLookup only gives up after the retries of the system-resolver, the lookup is aborted at our timeout*/
+void DnsTracker::expire_qt_lookup() {
+    if (m_dns) {
+        QObject::disconnect(m_dns, nullptr, this, nullptr);
+        m_dns->abort();
+        m_dns->deleteLater();
+        m_dns = nullptr;
+    }
+    DnsLookupResult result;
+    result.error = QDnsLookup::ResolverError;
+    result.error_string = "Request timed out";
+    result.timeout = true;
+    DnsTracker::handle_result(result);
+}
+
+void DnsTracker::read_qt_lookup() {
+    m_lookup_timeout.stop();
+    DnsLookupResult result;
     if (!m_dns) {
-        std::cerr << "Unspecified error during dns-request." << std::endl;
-        emit finished();
-        this->deleteLater();
+        result.error = QDnsLookup::ResolverError;
+        result.error_string = "Unspecified error during dns-request.";
+        DnsTracker::handle_result(result);
         return;
     }
-    if (m_dns->error() != QDnsLookup::NoError) {
-        std::cerr << "Error during DNS: " << m_dns->errorString().toStdString() << std::endl;
-        emit finished();
-        this->deleteLater();
+
+    result.error = m_dns->error();
+    result.error_string = m_dns->errorString();
+    result.records = m_read_qt(*m_dns);
+    DnsTracker::handle_result(result);
+}
+
+void DnsTracker::handle_result(const DnsLookupResult& result) {
+    //Answer of a lookup sent before the stop
+    if (m_stopped) {
         return;
     }
+    m_last_rtt_us = m_rtt_clock.isValid() ? m_rtt_clock.nsecsElapsed() / 1000 : -1;
+    //Send to answer (or timeout), taken from the RTT-measurement
+    if (m_last_rtt_us >= 0) {
+        TRACE_COMPLETE("lookup.resolve", TRACE_NOW() - m_last_rtt_us, m_options.target_id);
+    }
+    if (m_holds_slot) {
+        m_limiter->release();
+        m_holds_slot = false;
+    }
+    if (m_latency && result.error == QDnsLookup::NoError) {
+        m_latency->record(m_last_rtt_us, DnsTracker::current_time_ms());
+    }
+    if (m_metrics) {
+        auto& counter = result.error == QDnsLookup::NoError ? m_metrics->responses : m_metrics->errors;
+        counter.fetch_add(1, std::memory_order_relaxed);
+        if (result.error == QDnsLookup::NoError && m_last_rtt_us >= 0) {
+            m_metrics->record_rtt(m_last_rtt_us);
+        }
+        if (result.timeout) {
+            m_metrics->timeouts.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 
-    if (m_options.dns_type.toUpper() == "A") {
-        DnsADisplayData data;
-        data.cur_response = m_dns->hostAddressRecords();
-        data.server = m_options.dns_server;
-        data.cur_timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+    //Transient errors are retried with doubled backoff, only the last attempt is an observation
+    if (DnsTracker::is_transient(result) && m_attempt < m_options.retries) {
+        const qint64 backoff_ms = m_options.retry_backoff_ms << qMin(m_attempt, 16);
+        ++m_attempt;
+        if (m_metrics) {
+            m_metrics->retries.fetch_add(1, std::memory_order_relaxed);
+        }
+        DnsTracker::schedule_lookup(backoff_ms);
+        return;
+    }
+    m_attempt = 0;
 
-        emit send_a_update(data);
-    } else if (m_options.dns_type.toUpper() == "SRV") {
-        DnsSrvDisplayData data;
-        data.cur_response = m_dns->serviceRecords();
-        data.server = m_options.dns_server;
-        data.cur_timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+    if (m_options.continue_measurment) {
+        DnsTracker::start_tracking(result);
+    } else {
+        DnsTracker::display_single_lookup(result);
+    }
+}
 
-        emit send_srv_update(data);
+void DnsTracker::display_single_lookup(const DnsLookupResult& result) {
+    if (result.error != QDnsLookup::NoError) {
+        std::cerr << "Error during DNS: " << result.error_string.toStdString() << std::endl;
+        DnsTracker::report_error(result);
+        emit finished();
+        this->deleteLater();
+        return;
     }
 
-    m_dns->deleteLater();
+    DnsDisplayData data;
+    DnsTracker::fill_data(data);
+    data.cur_response = result.records;
+    data.cur_hash = Hashing::hash_record_set(data.cur_response, m_options.record_type);
+    data.new_hash = true;
+    data.rtt_us = m_last_rtt_us;
+    data.ttl = min_ttl(data.cur_response);
+    emit send_update(data);
+
+    if (m_dns) {
+        m_dns->deleteLater();
+    }
     emit finished();
     this->deleteLater();
     return;
 }
 
-void DnsTracker::start_tracking() {
-    if (!m_dns) {
-        std::cerr << "Unspecified error during dns-request." << std::endl;
-        emit finished();
-        this->deleteLater();
+void DnsTracker::start_tracking(const DnsLookupResult& result) {
+    //An error does not end the tracking, the previous hash stays so a change behind it is still seen
+    if (result.error != QDnsLookup::NoError) {
+        DnsTracker::report_error(result);
+        qint64 delay_ms = static_cast<qint64>(m_options.sleep_intervall);
+        if (m_options.adaptive_polling) {
+            delay_ms = DnsTracker::adaptive_delay(false, NO_TTL);
+        }
+        DnsTracker::schedule_lookup(delay_ms);
         return;
     }
-    if (m_dns->error() != QDnsLookup::NoError) {
-        std::cerr << "Error during DNS: " << m_dns->errorString().toStdString() << std::endl;
-        emit finished();
-        this->deleteLater();
+
+    const bool hash_changed = DnsTracker::analyze(result);
+
+    if (hash_changed && m_metrics) {
+        m_metrics->changes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    DnsTracker::change_member_values();
+    qint64 delay_ms = static_cast<qint64>(m_options.sleep_intervall);
+    if (m_options.adaptive_polling) {
+        delay_ms = DnsTracker::adaptive_delay(hash_changed, min_ttl(result.records));
+        if (m_metrics) {
+            m_metrics->queries_saved.store(DnsTracker::fixed_interval_queries() - qMin(m_queries_sent, DnsTracker::fixed_interval_queries()),
+                                           std::memory_order_relaxed);
+        }
+    }
+
+    DnsTracker::schedule_lookup(delay_ms);
+}
+
+void DnsTracker::stop() {
+    if (m_stopped) {
         return;
     }
+    m_stopped = true;
+    if (m_scheduler) {
+        m_scheduler->cancel(m_schedule_id);
+    }
+    m_lookup_timeout.stop();
+    if (m_holds_slot) {
+        m_limiter->release();
+        m_holds_slot = false;
+    }
+    emit finished();
+    this->deleteLater();
+}
 
-    bool hash_changed = false;
-    if (m_options.dns_type.toUpper() == "SRV") {
-        hash_changed = DnsTracker::analyze_srv();
-    } else if (m_options.dns_type.toUpper() == "A") {
-        hash_changed = DnsTracker::analyze_a();
+void DnsTracker::schedule_lookup(qint64 delay_ms) {
+    if (m_scheduler) {
+        m_scheduler->schedule(m_schedule_id, delay_ms);
+    } else {
+        QTimer::singleShot(static_cast<int>(delay_ms), this, &DnsTracker::run_lookup);
     }
+}
+
+/*No answer from the server or an answer the resolver could not give, a later attempt may succeed*/
+bool DnsTracker::is_transient(const DnsLookupResult& result) {
+    return result.timeout || result.error == QDnsLookup::ResolverError || result.error == QDnsLookup::ServerFailureError;
+}
+
+/*Identity of the target and time of the observation*/
+void DnsTracker::fill_data(DnsDisplayData& data) const {
+    data.server_id = m_options.server_id;
+    data.target_id = m_options.target_id;
+    data.server = m_options.dns_server;
+    data.name = m_options.dns_name;
+    data.type = m_options.record_type;
+    data.cur_time_ms = DnsTracker::current_time_ms();
+}
+
+void DnsTracker::report_error(const DnsLookupResult& result) {
+    DnsDisplayData data;
+    DnsTracker::fill_data(data);
+    data.rtt_us = result.timeout ? -1 : m_last_rtt_us;
+    data.error = result.error;
+    data.timeout = result.timeout;
+    data.error_string = result.error_string;
+    emit send_update(data);
+}
+
+/*A cached answer can not change before its TTL is over, so the next query is sent just after that.
+  Without a usable TTL the interval doubles while the answer is stable, after a change a few
+  queries are sent in the short burst-interval*/
+qint64 DnsTracker::adaptive_delay(bool hash_changed, quint32 ttl) {
+    const qint64 burst_ms = m_options.burst_interval_ms;
+    const qint64 max_ms = qMax(m_options.max_interval_ms, burst_ms);
 
     if (hash_changed) {
-        /*emit finished();
-        this->deleteLater();
-        return;*/
+        m_burst_left = BURST_QUERIES;
+        m_backoff_ms = burst_ms;
+    }
+    if (m_burst_left > 0) {
+        --m_burst_left;
+        return burst_ms;
     }
 
-    DnsTracker::change_member_values();
-    QTimer::singleShot(m_options.sleep_intervall, this, &DnsTracker::run_lookup);
+    //While stable the backoff grows, but the next query is never later than the expiry of the
+    //cached answer, a change behind it is seen right after the resolver has refreshed
+    m_backoff_ms = m_backoff_ms <= 0 ? burst_ms : qMin(m_backoff_ms * 2, max_ms);
+    const qint64 ttl_ms = static_cast<qint64>(ttl) * 1000 + TTL_MARGIN_MS;
+    return qBound(burst_ms, qMin(m_backoff_ms, ttl_ms), max_ms);
 }
 
-/*Used for measurement between start and change-detection, currently not active*/
-QTime DnsTracker::calculate_delay(qint64 end_time) {
-    qint64 duration = end_time - m_start_time;
-    QTime duration_time(0,0);
-    duration_time = duration_time.addMSecs(duration);
-    return duration_time;
+/*Queries a fixed interval would have sent since the first one*/
+quint64 DnsTracker::fixed_interval_queries() const {
+    if (m_queries_sent == 0 || m_options.sleep_intervall == 0) {
+        return m_queries_sent;
+    }
+    const qint64 elapsed = DnsTracker::current_time_ms() - m_first_query_ms;
+    return static_cast<quint64>(elapsed / static_cast<qint64>(m_options.sleep_intervall)) + 1;
 }
 
-bool DnsTracker::analyze_srv() {
-    DnsSrvDisplayData data;
+/*The TTL counts down from the moment the resolver fetched the answer, so its age is
+  original TTL - remaining TTL. The remaining TTL is truncated to seconds and the answer
+  is seen half a round-trip later, the refresh also has to lie between the two polls.
+  If the TTL was lowered together with the change, the countdown says nothing, then only
+  the two polls bound the refresh*/
+void DnsTracker::estimate_refresh(bool hash_changed, DnsDisplayData& data) {
+    const qint64 now = data.cur_time_ms;
+    const qint64 prev_poll = m_prev_poll_ms;
+    m_prev_poll_ms = now;
 
-    m_cur_srv_response = m_dns->serviceRecords();
-    m_cur_srv_hash = Hashing::hash_srv_record(m_dns->serviceRecords());
-    bool hash_changed = DnsTracker::compare_hash(m_prev_srv_hash, m_cur_srv_hash);
-    if (hash_changed) {
-        qint64 end_time = QDateTime::currentMSecsSinceEpoch();
-        data.end_timestamp = QDateTime::fromMSecsSinceEpoch(end_time).toString(Qt::ISODate);
-        data.duration = DnsTracker::calculate_delay(end_time).toString("hh:mm:ss");
+    if (!hash_changed) {
+        m_origin_ttl = qMax(m_origin_ttl, data.ttl);
+        return;
     }
+    //A new answer mostly carries the TTL of the old one
+    const quint32 origin = qMax(m_origin_ttl, data.ttl);
+    m_origin_ttl = data.ttl;
 
-    data.server = m_options.dns_server;
-    data.prev_response = m_prev_srv_response;
-    data.cur_response = m_cur_srv_response;
-    data.cur_hash = m_cur_srv_hash;
-    data.cur_timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-    data.hash_changed = hash_changed;
-    emit send_srv_update(data);
+    const qint64 half_rtt = data.rtt_us > 0 ? data.rtt_us / 2000 : 0;
+    const qint64 age_ms = static_cast<qint64>(origin - data.ttl) * 1000;
+    qint64 earliest = now - half_rtt - age_ms - 1000;
+    qint64 latest = now - half_rtt - age_ms;
+    if (prev_poll >= 0) {
+        earliest = qBound(prev_poll, earliest, now);
+        latest = qBound(prev_poll, latest, now);
+        if (age_ms > now - prev_poll || latest <= earliest) {
+            earliest = prev_poll;
+            latest = now;
+        }
+    }
+    data.refresh_ms = (earliest + latest) / 2;
+    data.refresh_error_ms = (latest - earliest + 1) / 2;
+    data.propagation_ms = DnsTracker::calculate_delay(data.refresh_ms);
+}
 
-    return hash_changed;
+/*Used for measurement between start and change in ms*/
+qint64 DnsTracker::calculate_delay(qint64 end_time) const {
+    return end_time - m_start_time;
 }
 
-bool DnsTracker::analyze_a() {
-    DnsADisplayData data;
+bool DnsTracker::analyze(const DnsLookupResult& result) {
+    DnsDisplayData data;
 
-    m_cur_a_response = m_dns->hostAddressRecords();
-    m_cur_a_hash = Hashing::hash_a_record(m_dns->hostAddressRecords());
-    bool hash_changed = DnsTracker::compare_hash(m_prev_a_hash, m_cur_a_hash);
-    if (hash_changed) {
-        qint64 end_time = QDateTime::currentMSecsSinceEpoch();
-        data.end_timestamp = QDateTime::fromMSecsSinceEpoch(end_time).toString(Qt::ISODate);
-        data.duration = DnsTracker::calculate_delay(end_time).toString("hh:mm:ss");
+    //Records reused by the resolver for an unchanged raw answer have the hash of the last one
+    if (!result.unchanged || m_cur_hash.isEmpty()) {
+        TRACE_SCOPE("hash", m_options.target_id);
+        m_cur_hash = Hashing::hash_record_set(result.records, m_options.record_type);
     }
+    bool hash_changed = DnsTracker::compare_hash(m_prev_hash, m_cur_hash);
 
-    data.server = m_options.dns_server;
-    data.prev_response = m_prev_a_response;
-    data.cur_response = m_cur_a_response;
-    data.cur_hash = m_cur_a_hash;
-    data.cur_timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
+    DnsTracker::fill_data(data);
+    data.cur_hash = m_cur_hash;
+    data.rtt_us = m_last_rtt_us;
     data.hash_changed = hash_changed;
-    emit send_a_update(data);
+    data.ttl = min_ttl(result.records);
+    DnsTracker::estimate_refresh(hash_changed, data);
+    if (!m_known_hashes.contains(m_cur_hash)) {
+        m_known_hashes.insert(m_cur_hash);
+        data.new_hash = true;
+        data.cur_response = result.records;
+    } else if (m_options.file_export) {
+        //The csv-row holds the TTL of every record, the list is shared and not copied
+        data.cur_response = result.records;
+    }
+    emit send_update(data);
 
     return hash_changed;
 }
 
-/*Used for comparing response and automatic program-exit, currently not active*/
+/*Time of the installed clock: the system-clock, or the virtual one of a simulation*/
+qint64 DnsTracker::current_time_ms() {
+    return Clock::instance()->now_ms();
+}
+
+/*Used for comparing response, a change ends the polling only through the convergence-monitor*/
 bool DnsTracker::compare_hash(const QByteArray& prev_hash, const QByteArray& cur_hash) {
     if (prev_hash.isEmpty()) {
         return false;
@@ -203,8 +471,5 @@ bool DnsTracker::compare_hash(const QByteArray& prev_hash, const QByteArray& cur
 
 
 void DnsTracker::change_member_values() {
-    m_prev_a_hash = m_cur_a_hash;
-    m_prev_a_response = m_cur_a_response;
-    m_prev_srv_hash = m_cur_srv_hash;
-    m_prev_srv_response = m_cur_srv_response;
+    m_prev_hash = m_cur_hash;
 }
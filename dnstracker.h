@@ -26,45 +26,101 @@
 #include <QCoreApplication>
 #include <QDnsLookup>
 #include <QFile>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QTimer>
+
+#include "dnsrecord.h"
+#include "csvexporter.h"
+
+class Scheduler;
+class DnsResolver;
+class LatencyHistogram;
+class RateLimiter;
+class AnswerScript;
+struct TargetMetrics;
 
 struct Options {
     QString dns_type;
+    //dns_type resolved once at setup
+    QDnsLookup::Type record_type = QDnsLookup::A;
     QString dns_name;
     QString dns_server;
+    //Only the native backend can ask another port than 53
+    quint16 dns_port = 53;
+    //Interned ids of dns_server and dns_name, the display keys its history by them
+    quint32 server_id = 0;
+    quint32 target_id = 0;
+    QList<QString> multi_dns_name;
     QList<QString> multi_dns_server;
     QString filepath;
+    QString binary_filepath;
+    QString replay_filepath;
+    QString targets_filepath;
+    //Virtual-time simulation of continues-mode, 0 runs in real time
+    qint64 simulate_ms = 0;
+    QString answers_filepath;
+    //Chrome trace-events, dumped on SIGUSR1 and at exit (only with tracing compiled in)
+    QString trace_filepath;
+    //Share of the servers a new answer needs to stop the polling of its target, 0: never stops
+    double converge_quorum = 0;
+    double replay_speed = 1.0;
+    CsvExporter::Settings export_settings;
     size_t sleep_intervall = 60000;
+    size_t start_spread = 0;
+    int max_fps = 10;
+    //Worker-threads of the tracker-pool, 0 picks one per core
+    int threads = 0;
+    qint64 rtt_window_ms = 0;
+    bool adaptive_polling = false;
+    qint64 burst_interval_ms = 5000;
+    qint64 max_interval_ms = 3600000;
+    //Per lookup: timeout, retries of transient errors with doubled backoff
+    int timeout_ms = 5000;
+    int retries = 2;
+    qint64 retry_backoff_ms = 1000;
+    //Per DNS-server: queries per second (0 = unlimited), burst and cap of queries in flight (0 = none)
+    double rate_limit = 0;
+    int rate_burst = 1;
+    int max_in_flight = 0;
+    QString metrics_address;
+    quint16 metrics_port = 0;
     bool verbose = false;
     bool continue_measurment = false;
     bool file_export = false;
+    bool binary_export = false;
     bool multi_requests = false;
+    bool native_backend = false;
+    bool batched_io = false;
+    bool io_uring = false;
+    bool io_stats = false;
+    bool legacy_hash = false;
     bool show_help = false;
 };
 
-struct DnsADisplayData {
+/*Update-event of one lookup. The records are only filled (new_hash) when
+  the tracker sees a hash for the first time, otherwise the hash is the handle*/
+struct DnsDisplayData {
+    quint32 server_id = 0;
+    quint32 target_id = 0;
     QString server;
+    QString name;
+    QDnsLookup::Type type = QDnsLookup::A;
     bool hash_changed = false;
-    QString prev_timestamp;
-    QList<QDnsHostAddressRecord> prev_response;
-    QString cur_timestamp;
+    bool new_hash = false;
+    qint64 cur_time_ms = 0;
+    qint64 rtt_us = -1;
+    quint32 ttl = 0;
+    //Estimated refresh of the resolver after a change (from the TTL-countdown) and its error-bound
+    qint64 refresh_ms = -1;
+    qint64 refresh_error_ms = 0;
+    qint64 propagation_ms = -1;
+    //A failed lookup (after its retries) is an observation without hash and records
+    QDnsLookup::Error error = QDnsLookup::NoError;
+    bool timeout = false;
+    QString error_string;
     QByteArray cur_hash;
-    QList<QDnsHostAddressRecord> cur_response;
-    QString start_timestamp;
-    QString end_timestamp;
-    QString duration;
-};
-
-struct DnsSrvDisplayData {
-    QString server;
-    bool hash_changed = false;
-    QString prev_timestamp;
-    QList<QDnsServiceRecord> prev_response;
-    QString cur_timestamp;
-    QByteArray cur_hash;
-    QList<QDnsServiceRecord> cur_response;
-    QString start_timestamp;
-    QString end_timestamp;
-    QString duration;
+    DnsRecordSet cur_response;
 };
 
 class DnsTracker : public QObject {
@@ -72,40 +128,93 @@ class DnsTracker : public QObject {
 
 public:
     DnsTracker(const Options& options, QObject *parent = nullptr);
+    void attach_scheduler(Scheduler* scheduler);
+    bool attach_resolver(DnsResolver* resolver);
+    void attach_latency(LatencyHistogram* histogram);
+    void attach_metrics(TargetMetrics* metrics);
+    void attach_limiter(RateLimiter* limiter);
+    //Simulation: answers come from the script instead of a DNS-server
+    void attach_answers(const AnswerScript* answers);
+    static qint64 current_time_ms();
+
+    quint32 target_id() const { return m_options.target_id; }
+    quint64 queries_sent() const { return m_queries_sent; }
+    quint64 fixed_interval_queries() const;
 
 public slots:
     void start();
+    void poll();
+    //Ends the polling, e.g. once the target has converged on all servers
+    void stop();
 
 signals:
-    void send_srv_update(DnsSrvDisplayData cur_data);
-    void send_a_update(DnsADisplayData cur_data);
+    void send_update(const DnsDisplayData& cur_data);
     void finished();
 
 private:
     QDnsLookup* m_dns = nullptr;
+    //Reads the answers of QDnsLookup for the record-type, chosen once in the constructor
+    DnsRecordSet (*m_read_qt)(const QDnsLookup& lookup) = nullptr;
+    Scheduler* m_scheduler = nullptr;
+    quint32 m_schedule_id = 0;
+    DnsResolver* m_resolver = nullptr;
+    quint32 m_query_handle = 0;
+    LatencyHistogram* m_latency = nullptr;
+    TargetMetrics* m_metrics = nullptr;
+    RateLimiter* m_limiter = nullptr;
+    const AnswerScript* m_answers = nullptr;
+    bool m_holds_slot = false;
+    bool m_stopped = false;
+    //Failed attempts of the current lookup, the Qt-backend has no timeout of its own
+    int m_attempt = 0;
+    QTimer m_lookup_timeout;
+
+    //Adaptive polling: queries in burst-interval after a change, backoff while stable
+    static constexpr int BURST_QUERIES = 5;
+    static constexpr qint64 TTL_MARGIN_MS = 250;
+    //A failed lookup has no TTL, only the backoff limits its delay
+    static constexpr quint32 NO_TTL = 0xFFFFFFFF;
+    int m_burst_left = 0;
+    qint64 m_backoff_ms = 0;
+    quint64 m_queries_sent = 0;
+    qint64 m_first_query_ms = 0;
+
+    //Largest TTL seen for the current answer, which is taken as its original TTL
+    quint32 m_origin_ttl = 0;
+    qint64 m_prev_poll_ms = -1;
     Options m_options;
-    qint64 m_start_time;
+    qint64 m_start_time = 0;
+    QElapsedTimer m_rtt_clock;
+    qint64 m_last_rtt_us = -1;
 
-    QByteArray m_prev_a_hash;
-    QList<QDnsHostAddressRecord> m_prev_a_response;
-    QByteArray m_cur_a_hash;
-    QList<QDnsHostAddressRecord> m_cur_a_response;
-
-    QByteArray m_prev_srv_hash;
-    QList<QDnsServiceRecord> m_prev_srv_response;
-    QByteArray m_cur_srv_hash;
-    QList<QDnsServiceRecord> m_cur_srv_response;
+    QByteArray m_prev_hash;
+    QByteArray m_cur_hash;
+    //Hashes whose records were already sent with an update
+    QSet<QByteArray> m_known_hashes;
 
     void run_lookup();
-    void start_tracking();
-    void display_single_lookup();
+    void read_qt_lookup();
+    void handle_result(const DnsLookupResult& result);
+    void expire_qt_lookup();
+    void schedule_lookup(qint64 delay_ms);
+    void report_error(const DnsLookupResult& result);
+    void fill_data(DnsDisplayData& data) const;
+    static bool is_transient(const DnsLookupResult& result);
+    void start_tracking(const DnsLookupResult& result);
+    void display_single_lookup(const DnsLookupResult& result);
     void display_summary(qint64 end_time);
     void change_member_values();
 
-    bool analyze_srv();
-    bool analyze_a();
+    bool analyze(const DnsLookupResult& result);
+    qint64 adaptive_delay(bool hash_changed, quint32 ttl);
+    void estimate_refresh(bool hash_changed, DnsDisplayData& data);
     bool compare_hash(const QByteArray& prev_hash, const QByteArray& cur_hash);
-    QTime calculate_delay(qint64 end_time);
+    qint64 calculate_delay(qint64 end_time) const;
+
+    template <typename Traits>
+    static DnsRecordSet read_records(const QDnsLookup& lookup) {
+        return Traits::read(lookup);
+    }
 
 };
 
@@ -0,0 +1,392 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the DNS-wire-format encoder and decoder. Queries are
+ * always sent with RD-bit and an EDNS0-OPT-record, so larger SRV-sets
+ * still fit into one UDP-datagram.
+ * The decoder is bounds-checked on every read and follows compression-
+ * pointers only backwards, so a malformed answer can't loop.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "dnswire.h"
+#include "recordtraits.h"
+
+#include <QHostAddress>
+#include <QUrl>
+
+namespace {
+
+constexpr quint16 TYPE_OPT = 41;
+constexpr quint16 CLASS_IN = 1;
+
+constexpr quint8 FLAG_QR = 0x80;
+constexpr quint8 FLAG_TC = 0x02;
+constexpr quint8 FLAG_RD = 0x01;
+
+inline quint16 read_u16(const uchar* p) {
+    return static_cast<quint16>((p[0] << 8) | p[1]);
+}
+
+inline quint32 read_u32(const uchar* p) {
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+inline void append_u16(QByteArray& out, quint16 value) {
+    out.append(static_cast<char>(value >> 8));
+    out.append(static_cast<char>(value & 0xFF));
+}
+
+/*Reads a (possibly compressed) name starting at offset, offset is moved behind the name*/
+bool read_name(const uchar* data, qsizetype size, qsizetype& offset, QString* out) {
+    qsizetype pos = offset;
+    qsizetype end = -1;
+    qsizetype min_pointer = offset;
+    QByteArray name;
+
+    while (true) {
+        if (pos >= size) {
+            return false;
+        }
+        const quint8 len = data[pos];
+        if ((len & 0xC0) == 0xC0) {
+            if (pos + 1 >= size) {
+                return false;
+            }
+            const qsizetype target = ((len & 0x3F) << 8) | data[pos + 1];
+            if (end < 0) {
+                end = pos + 2;
+            }
+            if (target >= min_pointer) {
+                return false;
+            }
+            min_pointer = target;
+            pos = target;
+            continue;
+        }
+        if (len & 0xC0) {
+            return false;
+        }
+        ++pos;
+        if (len == 0) {
+            break;
+        }
+        if (pos + len > size || name.size() + len + 1 > 255) {
+            return false;
+        }
+        if (out) {
+            if (!name.isEmpty()) {
+                name.append('.');
+            }
+            name.append(reinterpret_cast<const char*>(data + pos), len);
+        }
+        pos += len;
+    }
+
+    offset = end < 0 ? pos : end;
+    if (out) {
+        *out = QUrl::fromAce(name);
+    }
+    return true;
+}
+
+bool invalid_reply(DnsLookupResult& result) {
+    result.error = QDnsLookup::InvalidReplyError;
+    result.error_string = "Invalid reply received";
+    return false;
+}
+
+/*Checks flags and rcode and skips the question-section, pos is moved to the first answer*/
+bool read_header(const uchar* data, qsizetype size, DnsLookupResult& result, qsizetype& pos, quint16& ancount) {
+    result.error = QDnsLookup::NoError;
+    result.error_string.clear();
+
+    if (size < DnsWire::HEADER_SIZE || !(data[2] & FLAG_QR)) {
+        return invalid_reply(result);
+    }
+    if (data[2] & FLAG_TC) {
+        result.error = QDnsLookup::InvalidReplyError;
+        result.error_string = "Reply was truncated";
+        return false;
+    }
+
+    switch (data[3] & 0x0F) {
+    case 0:
+        break;
+    case 2:
+        result.error = QDnsLookup::ServerFailureError;
+        result.error_string = "Server could not process the request";
+        return false;
+    case 3:
+        result.error = QDnsLookup::NotFoundError;
+        result.error_string = "Non existent domain";
+        return false;
+    case 5:
+        result.error = QDnsLookup::ServerRefusedError;
+        result.error_string = "Server refused to answer";
+        return false;
+    default:
+        return invalid_reply(result);
+    }
+
+    const quint16 qdcount = read_u16(data + 4);
+    ancount = read_u16(data + 6);
+    pos = DnsWire::HEADER_SIZE;
+
+    for (quint16 i = 0; i < qdcount; ++i) {
+        if (!read_name(data, size, pos, nullptr) || pos + 4 > size) {
+            return invalid_reply(result);
+        }
+        pos += 4;
+    }
+    return true;
+}
+
+//A and AAAA
+bool read_rdata(const uchar* data, qsizetype, qsizetype pos, quint16 rdlength, DnsARecord& record) {
+    if (rdlength == 4) {
+        record.value = QHostAddress(read_u32(data + pos));
+        return true;
+    }
+    if (rdlength == 16) {
+        record.value = QHostAddress(data + pos);
+        return true;
+    }
+    return false;
+}
+
+bool read_rdata(const uchar* data, qsizetype size, qsizetype pos, quint16 rdlength, DnsSrvRecord& record) {
+    if (rdlength < 7) {
+        return false;
+    }
+    record.priority = read_u16(data + pos);
+    record.weight = read_u16(data + pos + 2);
+    record.port = read_u16(data + pos + 4);
+    qsizetype target_pos = pos + 6;
+    return read_name(data, size, target_pos, &record.target);
+}
+
+bool read_rdata(const uchar* data, qsizetype size, qsizetype pos, quint16 rdlength, DnsMxRecord& record) {
+    if (rdlength < 3) {
+        return false;
+    }
+    record.preference = read_u16(data + pos);
+    qsizetype exchange_pos = pos + 2;
+    return read_name(data, size, exchange_pos, &record.exchange);
+}
+
+bool read_rdata(const uchar* data, qsizetype, qsizetype pos, quint16 rdlength, DnsTxtRecord& record) {
+    const qsizetype end = pos + rdlength;
+    while (pos < end) {
+        const quint8 len = data[pos];
+        if (pos + 1 + len > end) {
+            return false;
+        }
+        record.values.append(QByteArray(reinterpret_cast<const char*>(data + pos + 1), len));
+        pos += 1 + len;
+    }
+    return true;
+}
+
+//CNAME and NS
+bool read_rdata(const uchar* data, qsizetype size, qsizetype pos, quint16, DnsNameRecord& record) {
+    return read_name(data, size, pos, &record.value);
+}
+
+template <typename Traits>
+bool decode_answers(const char* raw, qsizetype size, DnsLookupResult& result) {
+    const uchar* data = reinterpret_cast<const uchar*>(raw);
+    QList<typename Traits::Record> records;
+    result.records = records;
+
+    qsizetype pos = 0;
+    quint16 ancount = 0;
+    if (!read_header(data, size, result, pos, ancount)) {
+        return false;
+    }
+
+    for (quint16 i = 0; i < ancount; ++i) {
+        QString owner;
+        if (!read_name(data, size, pos, &owner) || pos + 10 > size) {
+            return invalid_reply(result);
+        }
+        const quint16 rr_type = read_u16(data + pos);
+        const quint16 rr_class = read_u16(data + pos + 2);
+        const quint32 ttl = read_u32(data + pos + 4);
+        const quint16 rdlength = read_u16(data + pos + 8);
+        pos += 10;
+        if (pos + rdlength > size) {
+            return invalid_reply(result);
+        }
+
+        //Other types in the answer (e.g. the CNAME-chain of an A-lookup) are skipped
+        if (rr_class == CLASS_IN && rr_type == Traits::TYPE) {
+            typename Traits::Record record;
+            record.name = owner;
+            record.ttl = ttl;
+            if (!read_rdata(data, size, pos, rdlength, record)) {
+                return invalid_reply(result);
+            }
+            records.append(record);
+        }
+        pos += rdlength;
+    }
+    result.records = std::move(records);
+    return true;
+}
+
+}
+
+bool DnsWire::append_name(QByteArray& out, const QString& name) {
+    QByteArray ace = QUrl::toAce(name);
+    if (ace.endsWith('.')) {
+        ace.chop(1);
+    }
+    const QList<QByteArray> labels = ace.split('.');
+    for (const auto& label : labels) {
+        if (label.isEmpty() || label.size() > 63) {
+            return false;
+        }
+        out.append(static_cast<char>(label.size()));
+        out.append(label);
+    }
+    out.append('\0');
+    return true;
+}
+
+QByteArray DnsWire::encode_query(const QString& name, quint16 type, quint16 id) {
+    QByteArray packet;
+    packet.reserve(HEADER_SIZE + name.size() + 2 + 4 + 11);
+    append_u16(packet, id);
+    packet.append(static_cast<char>(FLAG_RD));
+    packet.append('\0');
+    append_u16(packet, 1);  //QDCOUNT
+    append_u16(packet, 0);  //ANCOUNT
+    append_u16(packet, 0);  //NSCOUNT
+    append_u16(packet, 1);  //ARCOUNT (EDNS0)
+
+    if (!DnsWire::append_name(packet, name)) {
+        return QByteArray();
+    }
+    append_u16(packet, type);
+    append_u16(packet, CLASS_IN);
+
+    //OPT-pseudo-record: root-name, type, udp-size, ext-rcode/version/flags, rdlength
+    packet.append('\0');
+    append_u16(packet, TYPE_OPT);
+    append_u16(packet, EDNS_UDP_SIZE);
+    append_u16(packet, 0);
+    append_u16(packet, 0);
+    append_u16(packet, 0);
+    return packet;
+}
+
+void DnsWire::write_message_id(char* packet, quint16 id) {
+    packet[0] = static_cast<char>(id >> 8);
+    packet[1] = static_cast<char>(id & 0xFF);
+}
+
+quint16 DnsWire::read_message_id(const char* packet) {
+    return read_u16(reinterpret_cast<const uchar*>(packet));
+}
+
+/*Compares the question-section of a response with the one of the query, names case-insensitive*/
+bool DnsWire::question_matches(const char* response, qsizetype size, const QByteArray& query) {
+    const uchar* data = reinterpret_cast<const uchar*>(response);
+    const uchar* expected = reinterpret_cast<const uchar*>(query.constData());
+    if (size < HEADER_SIZE || read_u16(data + 4) != 1) {
+        return false;
+    }
+
+    qsizetype pos = HEADER_SIZE;
+    while (pos < query.size() && pos < size) {
+        uchar a = data[pos];
+        uchar b = expected[pos];
+        if (a >= 'A' && a <= 'Z') a += 'a' - 'A';
+        if (b >= 'A' && b <= 'Z') b += 'a' - 'A';
+        if (a != b) {
+            return false;
+        }
+        if (expected[pos] == 0) {
+            //End of name, type and class must follow identically
+            return pos + 5 <= size && pos + 5 <= query.size()
+                   && std::memcmp(data + pos + 1, expected + pos + 1, 4) == 0;
+        }
+        ++pos;
+    }
+    return false;
+}
+
+bool DnsWire::reuse_answer(const char* response, qsizetype size, const QByteArray& previous, quint16 type,
+                           DnsRecordSet& records) {
+    if (size != previous.size() || size < HEADER_SIZE) {
+        return false;
+    }
+    const uchar* data = reinterpret_cast<const uchar*>(response);
+    const uchar* expected = reinterpret_cast<const uchar*>(previous.constData());
+    //Header behind the message-id, the counts of the walk below are the same then
+    if (std::memcmp(data + 2, expected + 2, HEADER_SIZE - 2) != 0) {
+        return false;
+    }
+
+    const quint16 qdcount = read_u16(data + 4);
+    const quint16 ancount = read_u16(data + 6);
+    const int rrcount = ancount + read_u16(data + 8) + read_u16(data + 10);
+    qsizetype pos = HEADER_SIZE;
+    for (quint16 i = 0; i < qdcount; ++i) {
+        if (!read_name(data, size, pos, nullptr) || pos + 4 > size) {
+            return false;
+        }
+        pos += 4;
+    }
+
+    //Bytes before compared are equal, everything up to the next TTL is compared at once
+    qsizetype compared = HEADER_SIZE;
+    int record = 0;
+    for (int i = 0; i < rrcount; ++i) {
+        if (!read_name(data, size, pos, nullptr) || pos + 10 > size) {
+            return false;
+        }
+        const quint16 rr_type = read_u16(data + pos);
+        const quint16 rdlength = read_u16(data + pos + 8);
+        //The TTL-field of the OPT-record holds extended rcode and flags, it is compared
+        if (rr_type != TYPE_OPT) {
+            const qsizetype ttl_pos = pos + 4;
+            if (std::memcmp(data + compared, expected + compared, ttl_pos - compared) != 0) {
+                return false;
+            }
+            compared = ttl_pos + 4;
+            if (i < ancount && rr_type == type && read_u16(data + pos + 2) == CLASS_IN) {
+                const quint32 ttl = read_u32(data + ttl_pos);
+                std::visit([record, ttl](auto& list) {
+                    if (record < list.size()) {
+                        list[record].ttl = ttl;
+                    }
+                }, records);
+                ++record;
+            }
+        }
+        pos += 10 + rdlength;
+        if (pos > size) {
+            return false;
+        }
+    }
+    return std::memcmp(data + compared, expected + compared, size - compared) == 0;
+}
+
+DnsWire::Decoder DnsWire::decoder(QDnsLookup::Type type) {
+    Decoder result = nullptr;
+    dispatch_record_type(type, [&result](auto traits) {
+        result = &decode_answers<decltype(traits)>;
+    });
+    return result;
+}
@@ -0,0 +1,50 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * In the DnsWire-namespace are the helper-functions to encode queries
+ * and decode responses in DNS-wire-format (RFC 1035, RFC 2782) for the
+ * native lookup-backend.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef DNSWIRE_H
+#define DNSWIRE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "dnsrecord.h"
+
+namespace DnsWire {
+
+constexpr quint16 DNS_PORT = 53;
+constexpr int HEADER_SIZE = 12;
+constexpr quint16 EDNS_UDP_SIZE = 4096;
+
+QByteArray encode_query(const QString& name, quint16 type, quint16 id = 0);
+//Appends the name uncompressed in label-form, false for an empty or too long label
+bool append_name(QByteArray& out, const QString& name);
+void write_message_id(char* packet, quint16 id);
+quint16 read_message_id(const char* packet);
+bool question_matches(const char* response, qsizetype size, const QByteArray& query);
+/*Compares a response with the previous one, message-id and TTLs masked. On a match the TTLs
+  of the answers of the type are taken over into records, decoded from the previous response*/
+bool reuse_answer(const char* response, qsizetype size, const QByteArray& previous, quint16 type,
+                  DnsRecordSet& records);
+
+//Decodes the answers of one record-type, chosen once per query with decoder()
+using Decoder = bool (*)(const char* data, qsizetype size, DnsLookupResult& result);
+Decoder decoder(QDnsLookup::Type type);
+
+}
+
+#endif // DNSWIRE_H
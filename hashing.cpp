@@ -11,6 +11,9 @@
  * Purpose of this file:
  * In the Hasing-namespace are a bunch of helper-function for easy
  * and reliable comparison between the responses
+ * The fast path encodes every record into a stack-buffer and never
+ * allocates per record. Only names with non-ASCII-characters take the
+ * slow way over UTF-8.
  *
  * Author: Dennis Kuehnlein (2025)
 ********************************************************************/
@@ -21,20 +24,107 @@
 #include <QDnsLookup>
 #include <QHostAddress>
 #include <QCryptographicHash>
+#include <QStringList>
 
-static QString Hashing::normalize_name(const QString &name) {
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr qsizetype RECORD_BUFFER_SIZE = 300;
+constexpr quint64 RECORD_SEED = 0x5DEECE66DULL;
+constexpr quint64 FINAL_SEED = 0x2545F4914F6CDD1DULL;
+
+Hashing::Algorithm s_algorithm = Hashing::Algorithm::Fast128;
+
+inline quint64 rotl64(quint64 x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline quint64 fmix64(quint64 k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDULL;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline void put_u16(char* out, quint16 value) {
+    out[0] = static_cast<char>(value >> 8);
+    out[1] = static_cast<char>(value & 0xFF);
+}
+
+/*Order-independent accumulator, the sum of all record-hashes is finalized with the count*/
+struct Accumulator {
+    quint64 lo = 0;
+    quint64 hi = 0;
+    quint64 count = 0;
+
+    void add(const char* data, qsizetype size) {
+        quint64 h[2];
+        Hashing::murmur3_128(data, size, RECORD_SEED, h);
+        lo += h[0];
+        hi += h[1];
+        ++count;
+    }
+
+    QByteArray finish(quint8 tag) const {
+        char state[25];
+        std::memcpy(state, &lo, 8);
+        std::memcpy(state + 8, &hi, 8);
+        std::memcpy(state + 16, &count, 8);
+        state[24] = static_cast<char>(tag);
+        quint64 h[2];
+        Hashing::murmur3_128(state, sizeof(state), FINAL_SEED, h);
+
+        QByteArray result(16, Qt::Uninitialized);
+        std::memcpy(result.data(), h, 16);
+        return result;
+    }
+};
+
+QString normalize_name(const QString &name) {
     QString s = name.trimmed().toLower();
     if (s.endsWith('.')) s.chop(1);
     return s;
 }
 
-QByteArray Hashing::hash_a_record(const QList<QDnsHostAddressRecord>& record) {
+/*Text-form of the versions up to 1.4, kept unchanged for A and SRV so old results stay comparable*/
+QString legacy_key(const DnsARecord& rec) {
+    return QString("%1|%2").arg(normalize_name(rec.name), rec.value.toString());
+}
+
+QString legacy_key(const DnsSrvRecord& rec) {
+    return QString("%1|%2|%3").arg(rec.priority).arg(rec.weight).arg(normalize_name(rec.target));
+}
+
+QString legacy_key(const DnsMxRecord& rec) {
+    return QString("%1|%2").arg(rec.preference).arg(normalize_name(rec.exchange));
+}
+
+QString legacy_key(const DnsTxtRecord& rec) {
+    QStringList values;
+    for (const auto& value : rec.values) {
+        values << QString::fromUtf8(value.toHex());
+    }
+    return values.join('|');
+}
+
+QString legacy_key(const DnsNameRecord& rec) {
+    return normalize_name(rec.value);
+}
+
+template <typename Record>
+QByteArray legacy_hash(const QList<Record>& records) {
     QVector<QString> parts;
-    parts.reserve(record.size());
-    for (const auto& rec : record) {
-        QString name = normalize_name(rec.name());
-        QString target = rec.value().toString();
-        parts << QString("%1|%2").arg(name, target);
+    parts.reserve(records.size());
+    for (const auto& rec : records) {
+        parts << legacy_key(rec);
     }
 
     std::sort(parts.begin(), parts.end());
@@ -46,23 +136,234 @@ QByteArray Hashing::hash_a_record(const QList<QDnsHostAddressRecord>& record) {
     return QCryptographicHash::hash(joined_parts, QCryptographicHash::Md5);
 }
 
-QByteArray Hashing::hash_srv_record(const QList<QDnsServiceRecord>& record) {
-    QVector<QString> parts;
-    parts.reserve(record.size());
-    for (const auto& rec : record) {
-        QString target = normalize_name(rec.target());
-        QString part = QString("%1|%2|%3")
-                           .arg(rec.priority())
-                           .arg(rec.weight())
-                           .arg(target);
-        parts << part;
+/*Binary canonical form of one record, returns the size or -1 if the buffer is too small*/
+qsizetype canonical(const DnsARecord& rec, char* out, qsizetype capacity) {
+    qsizetype size = Hashing::encode_name(rec.name, out, capacity - 16);
+    if (size < 0) {
+        size = 0;
     }
-    std::sort(parts.begin(), parts.end());
-    QByteArray joined_parts;
-    for (const auto& p : parts) {
-        joined_parts.append(p.toUtf8());
-        joined_parts.append('\n');
+    if (rec.value.protocol() == QHostAddress::IPv6Protocol) {
+        const Q_IPV6ADDR address = rec.value.toIPv6Address();
+        std::memcpy(out + size, &address, 16);
+        return size + 16;
     }
-    return QCryptographicHash::hash(joined_parts, QCryptographicHash::Md5);
+    const quint32 address = rec.value.toIPv4Address();
+    put_u16(out + size, static_cast<quint16>(address >> 16));
+    put_u16(out + size + 2, static_cast<quint16>(address & 0xFFFF));
+    return size + 4;
+}
+
+qsizetype canonical(const DnsSrvRecord& rec, char* out, qsizetype capacity) {
+    put_u16(out, rec.priority);
+    put_u16(out + 2, rec.weight);
+    put_u16(out + 4, rec.port);
+    const qsizetype size = Hashing::encode_name(rec.target, out + 6, capacity - 6);
+    return (size < 0 ? 0 : size) + 6;
+}
+
+qsizetype canonical(const DnsMxRecord& rec, char* out, qsizetype capacity) {
+    put_u16(out, rec.preference);
+    const qsizetype size = Hashing::encode_name(rec.exchange, out + 2, capacity - 2);
+    return (size < 0 ? 0 : size) + 2;
+}
+
+qsizetype canonical(const DnsNameRecord& rec, char* out, qsizetype capacity) {
+    const qsizetype size = Hashing::encode_name(rec.value, out, capacity);
+    return size < 0 ? 0 : size;
+}
+
+//Character-strings as on the wire (length-byte and data), the owner-name is the same for all records
+qsizetype canonical(const DnsTxtRecord& rec, char* out, qsizetype capacity) {
+    qsizetype size = 0;
+    for (const auto& value : rec.values) {
+        const qsizetype length = qMin<qsizetype>(value.size(), 255);
+        if (size + 1 + length > capacity) {
+            return -1;
+        }
+        out[size] = static_cast<char>(length);
+        std::memcpy(out + size + 1, value.constData(), static_cast<size_t>(length));
+        size += 1 + length;
+    }
+    return size;
+}
+
+qsizetype canonical_capacity(const DnsTxtRecord& rec) {
+    return static_cast<qsizetype>(rec.values.size()) * 256;
+}
+
+template <typename Record>
+qsizetype canonical_capacity(const Record&) {
+    return RECORD_BUFFER_SIZE;
+}
+
+}
+
+void Hashing::set_algorithm(Algorithm algorithm) {
+    s_algorithm = algorithm;
+}
+
+Hashing::Algorithm Hashing::algorithm() {
+    return s_algorithm;
+}
+
+/*Narrows UTF-16 to ASCII and lowers A-Z, returns false as soon as a non-ASCII-character shows up*/
+bool Hashing::lowercase_ascii(const QChar* in, qsizetype size, char* out) {
+    const ushort* src = reinterpret_cast<const ushort*>(in);
+    qsizetype i = 0;
+
+#ifdef __SSE2__
+    const __m128i upper_a = _mm_set1_epi8('A' - 1);
+    const __m128i upper_z = _mm_set1_epi8('Z' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i ascii_limit = _mm_set1_epi16(0x7F);
+
+    for (; i + 16 <= size; i += 16) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        //Anything above 0x7F (as unsigned 16-bit) is not ASCII
+        const __m128i over = _mm_or_si128(_mm_subs_epu16(low, ascii_limit), _mm_subs_epu16(high, ascii_limit));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(over, _mm_setzero_si128())) != 0xFFFF) {
+            return false;
+        }
+        const __m128i bytes = _mm_packus_epi16(low, high);
+        const __m128i is_upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, upper_a), _mm_cmplt_epi8(bytes, upper_z));
+        const __m128i lowered = _mm_or_si128(bytes, _mm_and_si128(is_upper, case_bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lowered);
+    }
+#endif
+
+    for (; i < size; ++i) {
+        const ushort c = src[i];
+        if (c > 0x7F) {
+            return false;
+        }
+        out[i] = static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+    }
+    return true;
+}
+
+/*Writes the name in lower-case wire-format (length-prefixed labels, root-label at the end)*/
+qsizetype Hashing::encode_name(const QString& name, char* out, qsizetype capacity) {
+    qsizetype size = name.size();
+    if (size > 0 && name.at(size - 1) == QChar('.')) {
+        --size;
+    }
+    if (size + 2 > capacity) {
+        return -1;
+    }
+
+    if (!Hashing::lowercase_ascii(name.constData(), size, out + 1)) {
+        //IDN in unicode-form, lower-case it the Qt-way, allocation is fine for this rare case
+        const QByteArray utf8 = name.left(size).toLower().toUtf8();
+        size = utf8.size();
+        if (size + 2 > capacity) {
+            return -1;
+        }
+        std::memcpy(out + 1, utf8.constData(), size);
+    }
+
+    qsizetype label_start = 0;
+    for (qsizetype i = 1; i <= size; ++i) {
+        if (out[i] == '.') {
+            out[label_start] = static_cast<char>(i - label_start - 1);
+            label_start = i;
+        }
+    }
+    out[label_start] = static_cast<char>(size - label_start);
+    out[size + 1] = '\0';
+    return size + 2;
 }
 
+/*MurmurHash3_x64_128 by Austin Appleby (public domain)*/
+void Hashing::murmur3_128(const void* data, qsizetype size, quint64 seed, quint64 out[2]) {
+    const quint8* bytes = static_cast<const quint8*>(data);
+    const qsizetype blocks = size / 16;
+    const quint64 c1 = 0x87C37B91114253D5ULL;
+    const quint64 c2 = 0x4CF5AD432745937FULL;
+    quint64 h1 = seed;
+    quint64 h2 = seed;
+
+    for (qsizetype i = 0; i < blocks; ++i) {
+        quint64 k1;
+        quint64 k2;
+        std::memcpy(&k1, bytes + i * 16, 8);
+        std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    const quint8* tail = bytes + blocks * 16;
+    quint64 k1 = 0;
+    quint64 k2 = 0;
+    switch (size & 15) {
+    case 15: k2 ^= quint64(tail[14]) << 48; [[fallthrough]];
+    case 14: k2 ^= quint64(tail[13]) << 40; [[fallthrough]];
+    case 13: k2 ^= quint64(tail[12]) << 32; [[fallthrough]];
+    case 12: k2 ^= quint64(tail[11]) << 24; [[fallthrough]];
+    case 11: k2 ^= quint64(tail[10]) << 16; [[fallthrough]];
+    case 10: k2 ^= quint64(tail[9]) << 8; [[fallthrough]];
+    case 9:  k2 ^= quint64(tail[8]);
+             k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+             [[fallthrough]];
+    case 8:  k1 ^= quint64(tail[7]) << 56; [[fallthrough]];
+    case 7:  k1 ^= quint64(tail[6]) << 48; [[fallthrough]];
+    case 6:  k1 ^= quint64(tail[5]) << 40; [[fallthrough]];
+    case 5:  k1 ^= quint64(tail[4]) << 32; [[fallthrough]];
+    case 4:  k1 ^= quint64(tail[3]) << 24; [[fallthrough]];
+    case 3:  k1 ^= quint64(tail[2]) << 16; [[fallthrough]];
+    case 2:  k1 ^= quint64(tail[1]) << 8; [[fallthrough]];
+    case 1:  k1 ^= quint64(tail[0]);
+             k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+             break;
+    default:
+        break;
+    }
+
+    h1 ^= static_cast<quint64>(size);
+    h2 ^= static_cast<quint64>(size);
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    out[0] = h1;
+    out[1] = h2;
+}
+
+template <typename Record>
+QByteArray Hashing::hash_records(const QList<Record>& records, QDnsLookup::Type type) {
+    if (s_algorithm == Algorithm::Md5) {
+        return legacy_hash(records);
+    }
+
+    Accumulator acc;
+    char buffer[RECORD_BUFFER_SIZE];
+    QByteArray large;
+    for (const auto& rec : records) {
+        const qsizetype size = canonical(rec, buffer, RECORD_BUFFER_SIZE);
+        if (size >= 0) {
+            acc.add(buffer, size);
+        } else {
+            //Only long TXT-records do not fit the stack-buffer
+            large.resize(canonical_capacity(rec));
+            acc.add(large.constData(), canonical(rec, large.data(), large.size()));
+        }
+    }
+    return acc.finish(static_cast<quint8>(type));
+}
+
+template QByteArray Hashing::hash_records(const QList<DnsARecord>&, QDnsLookup::Type);
+template QByteArray Hashing::hash_records(const QList<DnsSrvRecord>&, QDnsLookup::Type);
+template QByteArray Hashing::hash_records(const QList<DnsMxRecord>&, QDnsLookup::Type);
+template QByteArray Hashing::hash_records(const QList<DnsTxtRecord>&, QDnsLookup::Type);
+template QByteArray Hashing::hash_records(const QList<DnsNameRecord>&, QDnsLookup::Type);
+
+QByteArray Hashing::hash_record_set(const DnsRecordSet& records, QDnsLookup::Type type) {
+    return std::visit([type](const auto& list) {
+        return Hashing::hash_records(list, type);
+    }, records);
+}
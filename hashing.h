@@ -11,6 +11,11 @@
  * Purpose of this file:
  * In the Hasing-namespace are a bunch of helper-function for easy
  * and reliable comparison between the responses
+ * Default is a binary canonical form of every record (wire-format-name
+ * in lower-case, raw address-bytes, integers) hashed with a 128-bit
+ * Murmur3, the record-hashes are summed up so the order of the records
+ * doesn't matter. The old MD5-hash over the sorted text-form is still
+ * available for compatibility.
  *
  * Author: Dennis Kuehnlein (2025)
 ********************************************************************/
@@ -21,12 +26,26 @@
 #include <QCoreApplication>
 #include <QDnsLookup>
 
+#include "dnsrecord.h"
+
 namespace Hashing {
 
+enum class Algorithm {
+    Fast128,
+    Md5
+};
+
+void set_algorithm(Algorithm algorithm);
+Algorithm algorithm();
+
+bool lowercase_ascii(const QChar* in, qsizetype size, char* out);
+qsizetype encode_name(const QString& name, char* out, qsizetype capacity);
+void murmur3_128(const void* data, qsizetype size, quint64 seed, quint64 out[2]);
 
-static QString normalize_name(const QString &name);
-QByteArray hash_a_record(const QList<QDnsHostAddressRecord>& record);
-QByteArray hash_srv_record(const QList<QDnsServiceRecord>& record);
+//The record-type is part of the hash, so A and AAAA (or CNAME and NS) with equal data differ
+template <typename Record>
+QByteArray hash_records(const QList<Record>& records, QDnsLookup::Type type);
+QByteArray hash_record_set(const DnsRecordSet& records, QDnsLookup::Type type);
 
 }
 
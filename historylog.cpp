@@ -0,0 +1,478 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the binary history-log. The writer uses the same
+ * background-writer as the csv-export (in binary mode), the reader
+ * works directly on the memory-mapped file. A chunk cut off at the end
+ * of the file (e.g. after a crash) is treated as end of the log.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "historylog.h"
+#include "recordtraits.h"
+
+#include <cstring>
+
+#include <QtEndian>
+
+namespace {
+
+inline void append_u8(QByteArray& out, quint8 value) {
+    out.append(static_cast<char>(value));
+}
+
+inline void append_u16(QByteArray& out, quint16 value) {
+    char buffer[2];
+    qToLittleEndian<quint16>(value, buffer);
+    out.append(buffer, 2);
+}
+
+inline void append_u32(QByteArray& out, quint32 value) {
+    char buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    out.append(buffer, 4);
+}
+
+inline void append_i64(QByteArray& out, qint64 value) {
+    char buffer[8];
+    qToLittleEndian<qint64>(value, buffer);
+    out.append(buffer, 8);
+}
+
+inline void append_string(QByteArray& out, const QString& value) {
+    const QByteArray utf8 = value.toUtf8();
+    append_u16(out, static_cast<quint16>(utf8.size()));
+    out.append(utf8);
+}
+
+inline void append_address(QByteArray& out, const QHostAddress& address) {
+    if (address.protocol() == QHostAddress::IPv6Protocol) {
+        const Q_IPV6ADDR ip = address.toIPv6Address();
+        append_u8(out, 16);
+        out.append(reinterpret_cast<const char*>(&ip), 16);
+    } else {
+        char buffer[4];
+        qToBigEndian<quint32>(address.toIPv4Address(), buffer);
+        append_u8(out, 4);
+        out.append(buffer, 4);
+    }
+}
+
+inline void append_bytes(QByteArray& out, const QByteArray& value) {
+    append_u16(out, static_cast<quint16>(value.size()));
+    out.append(value);
+}
+
+/*Payload-form of every record-struct, A and SRV are the forms of version 1*/
+void append_record(QByteArray& out, const DnsARecord& rec) {
+    append_string(out, rec.name);
+    append_address(out, rec.value);
+    append_u32(out, rec.ttl);
+}
+
+void append_record(QByteArray& out, const DnsSrvRecord& rec) {
+    append_string(out, rec.name);
+    append_string(out, rec.target);
+    append_u16(out, rec.priority);
+    append_u16(out, rec.weight);
+    append_u16(out, rec.port);
+    append_u32(out, rec.ttl);
+}
+
+void append_record(QByteArray& out, const DnsMxRecord& rec) {
+    append_string(out, rec.name);
+    append_string(out, rec.exchange);
+    append_u16(out, rec.preference);
+    append_u32(out, rec.ttl);
+}
+
+void append_record(QByteArray& out, const DnsTxtRecord& rec) {
+    append_string(out, rec.name);
+    append_u16(out, static_cast<quint16>(rec.values.size()));
+    for (const auto& value : rec.values) {
+        append_bytes(out, value);
+    }
+    append_u32(out, rec.ttl);
+}
+
+void append_record(QByteArray& out, const DnsNameRecord& rec) {
+    append_string(out, rec.name);
+    append_string(out, rec.value);
+    append_u32(out, rec.ttl);
+}
+
+/*Bounds-checked cursor over the mapped payload of one RRset*/
+struct Cursor {
+    const uchar* data;
+    qsizetype size;
+    qsizetype pos = 0;
+    bool ok = true;
+
+    bool need(qsizetype n) {
+        ok = ok && pos + n <= size;
+        return ok;
+    }
+    quint8 u8() {
+        return need(1) ? data[pos++] : 0;
+    }
+    quint16 u16() {
+        if (!need(2)) return 0;
+        const quint16 value = qFromLittleEndian<quint16>(data + pos);
+        pos += 2;
+        return value;
+    }
+    quint32 u32() {
+        if (!need(4)) return 0;
+        const quint32 value = qFromLittleEndian<quint32>(data + pos);
+        pos += 4;
+        return value;
+    }
+    QString string() {
+        const quint16 len = u16();
+        if (!need(len)) return QString();
+        const QString value = QString::fromUtf8(reinterpret_cast<const char*>(data + pos), len);
+        pos += len;
+        return value;
+    }
+    QByteArray bytes() {
+        const quint16 len = u16();
+        if (!need(len)) return QByteArray();
+        const QByteArray value(reinterpret_cast<const char*>(data + pos), len);
+        pos += len;
+        return value;
+    }
+    QHostAddress address() {
+        const quint8 len = u8();
+        if (!need(len)) return QHostAddress();
+        QHostAddress value;
+        if (len == 4) {
+            value = QHostAddress(qFromBigEndian<quint32>(data + pos));
+        } else if (len == 16) {
+            value = QHostAddress(data + pos);
+        }
+        pos += len;
+        return value;
+    }
+};
+
+void read_record(Cursor& cursor, DnsARecord& rec) {
+    rec.name = cursor.string();
+    rec.value = cursor.address();
+    rec.ttl = cursor.u32();
+}
+
+void read_record(Cursor& cursor, DnsSrvRecord& rec) {
+    rec.name = cursor.string();
+    rec.target = cursor.string();
+    rec.priority = cursor.u16();
+    rec.weight = cursor.u16();
+    rec.port = cursor.u16();
+    rec.ttl = cursor.u32();
+}
+
+void read_record(Cursor& cursor, DnsMxRecord& rec) {
+    rec.name = cursor.string();
+    rec.exchange = cursor.string();
+    rec.preference = cursor.u16();
+    rec.ttl = cursor.u32();
+}
+
+void read_record(Cursor& cursor, DnsTxtRecord& rec) {
+    rec.name = cursor.string();
+    const quint16 count = cursor.u16();
+    for (quint16 i = 0; i < count && cursor.ok; ++i) {
+        rec.values.append(cursor.bytes());
+    }
+    rec.ttl = cursor.u32();
+}
+
+void read_record(Cursor& cursor, DnsNameRecord& rec) {
+    rec.name = cursor.string();
+    rec.value = cursor.string();
+    rec.ttl = cursor.u32();
+}
+
+}
+
+HistoryWriter::HistoryWriter(const QString& filepath, const CsvExporter::Settings& settings) {
+    CsvExporter::Settings binary_settings = settings;
+    binary_settings.text_mode = false;
+    m_exporter = std::make_unique<CsvExporter>(filepath, binary_settings);
+}
+
+bool HistoryWriter::open() {
+    if (!m_exporter->open()) {
+        return false;
+    }
+    QByteArray header(HistoryLog::MAGIC, sizeof(HistoryLog::MAGIC));
+    append_u32(header, HistoryLog::VERSION);
+    append_u32(header, 0);
+    m_exporter->append(header);
+    return true;
+}
+
+quint32 HistoryWriter::server_id(const QString& server) {
+    auto it = m_servers.constFind(server);
+    if (it != m_servers.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = static_cast<quint32>(m_servers.size());
+    m_servers.insert(server, id);
+
+    m_chunk.clear();
+    append_u8(m_chunk, HistoryLog::Server);
+    append_u32(m_chunk, id);
+    append_string(m_chunk, server);
+    m_exporter->append(m_chunk);
+    return id;
+}
+
+quint32 HistoryWriter::target_id(const QString& name, quint16 type) {
+    const auto key = qMakePair(name, static_cast<int>(type));
+    auto it = m_targets.constFind(key);
+    if (it != m_targets.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = static_cast<quint32>(m_targets.size());
+    m_targets.insert(key, id);
+
+    m_chunk.clear();
+    append_u8(m_chunk, HistoryLog::Target);
+    append_u32(m_chunk, id);
+    append_u16(m_chunk, type);
+    append_string(m_chunk, name);
+    m_exporter->append(m_chunk);
+    return id;
+}
+
+/*Failed lookups have no RRset, only the error is kept*/
+bool HistoryWriter::write_error(const DnsDisplayData& data) {
+    if (data.error == QDnsLookup::NoError) {
+        return false;
+    }
+    const quint16 status = static_cast<quint16>(static_cast<quint16>(data.error) | (data.timeout ? HistoryLog::STATUS_TIMEOUT : 0));
+    HistoryWriter::write_observation(data.server, data.name, data.type, HistoryLog::NO_RRSET,
+                                     data.cur_time_ms, data.rtt_us, 0, false, status);
+    return true;
+}
+
+void HistoryWriter::record(const DnsDisplayData& data) {
+    if (HistoryWriter::write_error(data)) {
+        return;
+    }
+    quint32 hash_id;
+    auto it = m_rrsets.constFind(data.cur_hash);
+    if (it != m_rrsets.constEnd()) {
+        hash_id = it.value();
+    } else {
+        hash_id = static_cast<quint32>(m_rrsets.size());
+        m_rrsets.insert(data.cur_hash, hash_id);
+
+        QByteArray payload;
+        std::visit([&payload](const auto& records) {
+            append_u16(payload, static_cast<quint16>(records.size()));
+            for (const auto& rec : records) {
+                append_record(payload, rec);
+            }
+        }, data.cur_response);
+
+        m_chunk.clear();
+        append_u8(m_chunk, HistoryLog::RRset);
+        append_u32(m_chunk, hash_id);
+        append_u16(m_chunk, data.type);
+        append_u8(m_chunk, static_cast<quint8>(data.cur_hash.size()));
+        m_chunk.append(data.cur_hash);
+        append_u32(m_chunk, static_cast<quint32>(payload.size()));
+        m_chunk.append(payload);
+        m_exporter->append(m_chunk);
+    }
+    HistoryWriter::write_observation(data.server, data.name, data.type, hash_id,
+                                     data.cur_time_ms, data.rtt_us, data.ttl, data.hash_changed);
+}
+
+void HistoryWriter::write_observation(const QString& server, const QString& name, quint16 type, quint32 hash_id,
+                                      qint64 time_ms, qint64 rtt_us, quint32 ttl, bool changed, quint16 status) {
+    const quint32 sid = HistoryWriter::server_id(server);
+    const quint32 tid = HistoryWriter::target_id(name, type);
+
+    m_chunk.clear();
+    append_u8(m_chunk, HistoryLog::Observation);
+    append_u8(m_chunk, changed ? 1 : 0);
+    append_u16(m_chunk, status);
+    append_u32(m_chunk, rtt_us < 0 ? 0xFFFFFFFF : static_cast<quint32>(qMin<qint64>(rtt_us, 0xFFFFFFFE)));
+    append_i64(m_chunk, time_ms);
+    append_u32(m_chunk, sid);
+    append_u32(m_chunk, tid);
+    append_u32(m_chunk, hash_id);
+    append_u32(m_chunk, ttl);
+    m_exporter->append(m_chunk);
+}
+
+HistoryReader::~HistoryReader() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+}
+
+bool HistoryReader::open(const QString& filepath) {
+    m_file.setFileName(filepath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return HistoryReader::fail("File could not be opended: " + filepath);
+    }
+    m_size = m_file.size();
+    if (m_size < HistoryLog::HEADER_SIZE) {
+        return HistoryReader::fail("File is no dns-tracker history-log: " + filepath);
+    }
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        return HistoryReader::fail("File could not be mapped: " + m_file.errorString());
+    }
+    if (std::memcmp(m_data, HistoryLog::MAGIC, sizeof(HistoryLog::MAGIC)) != 0) {
+        return HistoryReader::fail("File is no dns-tracker history-log: " + filepath);
+    }
+    const quint32 version = qFromLittleEndian<quint32>(m_data + 8);
+    if (version < 1 || version > HistoryLog::VERSION) {
+        return HistoryReader::fail("Unsupported history-log version in " + filepath);
+    }
+    m_pos = HistoryLog::HEADER_SIZE;
+    return true;
+}
+
+void HistoryReader::rewind() {
+    m_pos = HistoryLog::HEADER_SIZE;
+}
+
+bool HistoryReader::next(Observation& observation) {
+    while (m_data && m_pos < m_size) {
+        const uchar* chunk = m_data + m_pos;
+        const qsizetype left = m_size - m_pos;
+
+        switch (chunk[0]) {
+        case HistoryLog::Observation:
+            if (left < HistoryLog::OBSERVATION_SIZE) {
+                return false;
+            }
+            observation.changed = chunk[1] != 0;
+            observation.error = qFromLittleEndian<quint16>(chunk + 2) & ~HistoryLog::STATUS_TIMEOUT;
+            observation.timeout = (qFromLittleEndian<quint16>(chunk + 2) & HistoryLog::STATUS_TIMEOUT) != 0;
+            observation.rtt_us = qFromLittleEndian<quint32>(chunk + 4);
+            observation.time_ms = qFromLittleEndian<qint64>(chunk + 8);
+            observation.server_id = qFromLittleEndian<quint32>(chunk + 16);
+            observation.target_id = qFromLittleEndian<quint32>(chunk + 20);
+            observation.hash_id = qFromLittleEndian<quint32>(chunk + 24);
+            observation.ttl = qFromLittleEndian<quint32>(chunk + 28);
+            m_pos += HistoryLog::OBSERVATION_SIZE;
+            return true;
+
+        case HistoryLog::Server:
+        case HistoryLog::Target: {
+            const qsizetype fixed = chunk[0] == HistoryLog::Server ? 7 : 9;
+            if (left < fixed) {
+                return false;
+            }
+            const quint32 id = qFromLittleEndian<quint32>(chunk + 1);
+            const quint16 len = qFromLittleEndian<quint16>(chunk + fixed - 2);
+            if (left < fixed + len) {
+                return false;
+            }
+            const QString name = QString::fromUtf8(reinterpret_cast<const char*>(chunk + fixed), len);
+            if (chunk[0] == HistoryLog::Server) {
+                if (m_servers.size() <= static_cast<qsizetype>(id)) {
+                    m_servers.resize(static_cast<qsizetype>(id) + 1);
+                }
+                m_servers[static_cast<qsizetype>(id)] = name;
+            } else {
+                if (m_targets.size() <= static_cast<qsizetype>(id)) {
+                    m_targets.resize(static_cast<qsizetype>(id) + 1);
+                }
+                m_targets[static_cast<qsizetype>(id)].name = name;
+                m_targets[static_cast<qsizetype>(id)].type = qFromLittleEndian<quint16>(chunk + 5);
+            }
+            m_pos += fixed + len;
+            break;
+        }
+
+        case HistoryLog::RRset: {
+            if (left < 8) {
+                return false;
+            }
+            const quint32 id = qFromLittleEndian<quint32>(chunk + 1);
+            RRsetEntry entry;
+            entry.type = qFromLittleEndian<quint16>(chunk + 5);
+            entry.hash_size = chunk[7];
+            entry.hash_offset = m_pos + 8;
+            if (left < 8 + entry.hash_size + 4) {
+                return false;
+            }
+            entry.payload_size = qFromLittleEndian<quint32>(chunk + 8 + entry.hash_size);
+            entry.payload_offset = entry.hash_offset + entry.hash_size + 4;
+            if (left < 8 + entry.hash_size + 4 + static_cast<qsizetype>(entry.payload_size)) {
+                return false;
+            }
+            if (m_rrsets.size() <= static_cast<qsizetype>(id)) {
+                m_rrsets.resize(static_cast<qsizetype>(id) + 1);
+            }
+            m_rrsets[static_cast<qsizetype>(id)] = entry;
+            m_pos = entry.payload_offset + entry.payload_size;
+            break;
+        }
+
+        default:
+            HistoryReader::fail(QString("Unknown chunk at offset %1").arg(static_cast<qint64>(m_pos)));
+            return false;
+        }
+    }
+    return false;
+}
+
+QString HistoryReader::target_name(quint32 id) const {
+    return id < static_cast<quint32>(m_targets.size()) ? m_targets[static_cast<qsizetype>(id)].name : QString();
+}
+
+quint16 HistoryReader::target_type(quint32 id) const {
+    return id < static_cast<quint32>(m_targets.size()) ? m_targets[static_cast<qsizetype>(id)].type : 0;
+}
+
+QByteArray HistoryReader::hash(quint32 hash_id) const {
+    if (hash_id >= static_cast<quint32>(m_rrsets.size())) {
+        return QByteArray();
+    }
+    const RRsetEntry& entry = m_rrsets[static_cast<qsizetype>(hash_id)];
+    return QByteArray(reinterpret_cast<const char*>(m_data + entry.hash_offset), entry.hash_size);
+}
+
+DnsRecordSet HistoryReader::records(quint32 hash_id) const {
+    DnsRecordSet result;
+    if (hash_id >= static_cast<quint32>(m_rrsets.size())) {
+        return result;
+    }
+    const RRsetEntry& entry = m_rrsets[static_cast<qsizetype>(hash_id)];
+    Cursor cursor{m_data + entry.payload_offset, static_cast<qsizetype>(entry.payload_size)};
+    dispatch_record_type(static_cast<QDnsLookup::Type>(entry.type), [&](auto traits) {
+        QList<typename decltype(traits)::Record> records;
+        const quint16 count = cursor.u16();
+        for (quint16 i = 0; i < count && cursor.ok; ++i) {
+            typename decltype(traits)::Record rec;
+            read_record(cursor, rec);
+            if (cursor.ok) {
+                records.append(rec);
+            }
+        }
+        result = std::move(records);
+    });
+    return result;
+}
+
+bool HistoryReader::fail(const QString& error) {
+    m_error = error;
+    return false;
+}
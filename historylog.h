@@ -0,0 +1,149 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The history-log is the compact binary alternative to the csv-export.
+ * The file is append-only: after the header follow chunks, every server,
+ * target and RRset is defined exactly once (RRsets keyed by their hash),
+ * every poll is a fixed-size observation of 32 bytes which only refers
+ * to the ids of these definitions.
+ * The reader maps the file into memory and scans it without copying,
+ * RRsets are only decoded when asked for.
+ *
+ * Layout (little-endian):
+ *   header       "DNSTRLOG" u32 version u32 reserved
+ *   server       u8 kind=1 u32 id u16 len name
+ *   target       u8 kind=2 u32 id u16 type u16 len name
+ *   rrset        u8 kind=3 u32 id u16 type u8 hash_len hash u32 len payload
+ *   observation  u8 kind=4 u8 changed u16 status u32 rtt_us i64 time_ms
+ *                u32 server_id u32 target_id u32 hash_id u32 ttl
+ *
+ * The status of a failed lookup is its QDnsLookup-error, bit 15 marks a
+ * timeout, its hash_id is NO_RRSET (version 1 had no failed lookups).
+ * The payload of an RRset is u16 count and the records in the form of its
+ * type (see append_record), so further record-types keep the version.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef HISTORYLOG_H
+#define HISTORYLOG_H
+
+#include <memory>
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "dnstracker.h"
+#include "csvexporter.h"
+
+namespace HistoryLog {
+
+constexpr char MAGIC[8] = {'D', 'N', 'S', 'T', 'R', 'L', 'O', 'G'};
+constexpr quint32 VERSION = 2;
+constexpr quint32 NO_RRSET = 0xFFFFFFFF;
+constexpr quint16 STATUS_TIMEOUT = 0x8000;
+constexpr int HEADER_SIZE = 16;
+constexpr int OBSERVATION_SIZE = 32;
+
+enum ChunkKind : quint8 {
+    Server = 1,
+    Target = 2,
+    RRset = 3,
+    Observation = 4
+};
+
+}
+
+class HistoryWriter {
+
+public:
+    HistoryWriter(const QString& filepath, const CsvExporter::Settings& settings);
+
+    bool open();
+    void record(const DnsDisplayData& data);
+    size_t queue_depth() const { return m_exporter->queue_depth(); }
+
+private:
+    std::unique_ptr<CsvExporter> m_exporter;
+    QHash<QString, quint32> m_servers;
+    QHash<QPair<QString, int>, quint32> m_targets;
+    QHash<QByteArray, quint32> m_rrsets;
+    QByteArray m_chunk;
+
+    quint32 server_id(const QString& server);
+    quint32 target_id(const QString& name, quint16 type);
+    void write_observation(const QString& server, const QString& name, quint16 type, quint32 hash_id,
+                           qint64 time_ms, qint64 rtt_us, quint32 ttl, bool changed, quint16 status = 0);
+    bool write_error(const DnsDisplayData& data);
+};
+
+class HistoryReader {
+
+public:
+    struct Observation {
+        qint64 time_ms = 0;
+        quint32 server_id = 0;
+        quint32 target_id = 0;
+        quint32 hash_id = 0;
+        quint32 rtt_us = 0;
+        quint32 ttl = 0;
+        bool changed = false;
+        //QDnsLookup-error of a failed lookup, hash_id is NO_RRSET then
+        quint16 error = 0;
+        bool timeout = false;
+    };
+
+    HistoryReader() = default;
+    ~HistoryReader();
+
+    bool open(const QString& filepath);
+    bool next(Observation& observation);
+    void rewind();
+
+    QString error_string() const { return m_error; }
+    QString server(quint32 id) const { return m_servers.value(static_cast<qsizetype>(id)); }
+    QString target_name(quint32 id) const;
+    quint16 target_type(quint32 id) const;
+    QByteArray hash(quint32 hash_id) const;
+    //Decoded in the form of the type the RRset was written with
+    DnsRecordSet records(quint32 hash_id) const;
+
+private:
+    struct TargetEntry {
+        QString name;
+        quint16 type = 0;
+    };
+    struct RRsetEntry {
+        qsizetype hash_offset = 0;
+        int hash_size = 0;
+        quint16 type = 0;
+        qsizetype payload_offset = 0;
+        quint32 payload_size = 0;
+    };
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qsizetype m_size = 0;
+    qsizetype m_pos = 0;
+    QString m_error;
+
+    QVector<QString> m_servers;
+    QVector<TargetEntry> m_targets;
+    QVector<RRsetEntry> m_rrsets;
+
+    bool fail(const QString& error);
+};
+
+#endif // HISTORYLOG_H
@@ -0,0 +1,221 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the latency-histograms. A slice which belongs to an
+ * old window is cleared by the first record of the new window, records
+ * racing with this clear may get lost, which is accepted for statistics.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "latencyhistogram.h"
+
+LatencyHistogram::Slice::Slice() {
+    for (auto& group : groups) {
+        group.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::Slice::~Slice() {
+    for (auto& group : groups) {
+        delete group.load(std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::LatencyHistogram(qint64 window_ms) : m_window_ms(window_ms), m_slice_count(window_ms > 0 ? 2 : 1) {}
+
+LatencyHistogram::~LatencyHistogram() {
+    delete[] m_slices.load(std::memory_order_relaxed);
+}
+
+LatencyHistogram::Slice* LatencyHistogram::slices_for_record() {
+    Slice* slices = m_slices.load(std::memory_order_acquire);
+    if (slices) {
+        return slices;
+    }
+    Slice* fresh = new Slice[m_slice_count];
+    if (m_window_ms <= 0) {
+        fresh[0].window.store(0, std::memory_order_relaxed);
+    }
+    if (m_slices.compare_exchange_strong(slices, fresh, std::memory_order_acq_rel)) {
+        return fresh;
+    }
+    delete[] fresh;
+    return slices;
+}
+
+/*Values below SUB_COUNT get one bucket each, above that every power of two is split into SUB_HALF buckets*/
+int LatencyHistogram::bucket_of(quint32 value_us) {
+    if (value_us < SUB_COUNT) {
+        return static_cast<int>(value_us);
+    }
+    const int msb = 31 - __builtin_clz(value_us);
+    const int shift = msb - (SUB_BITS - 1);
+    return shift * static_cast<int>(SUB_HALF) + static_cast<int>(value_us >> shift);
+}
+
+/*Middle of the bucket*/
+qint64 LatencyHistogram::value_of(int bucket) {
+    if (bucket < static_cast<int>(SUB_COUNT)) {
+        return bucket;
+    }
+    const int shift = bucket / static_cast<int>(SUB_HALF) - 1;
+    const qint64 sub = bucket - shift * static_cast<int>(SUB_HALF);
+    return (sub << shift) + ((qint64(1) << shift) - 1) / 2;
+}
+
+LatencyHistogram::Slice& LatencyHistogram::slice_for(qint64 now_ms) {
+    Slice* slices = LatencyHistogram::slices_for_record();
+    if (m_window_ms <= 0) {
+        return slices[0];
+    }
+    const qint64 window = now_ms / m_window_ms;
+    Slice& slice = slices[window & 1];
+    qint64 seen = slice.window.load(std::memory_order_acquire);
+    if (seen != window && slice.window.compare_exchange_strong(seen, window, std::memory_order_acq_rel)) {
+        for (auto& group_ptr : slice.groups) {
+            Group* group = group_ptr.load(std::memory_order_acquire);
+            if (!group) {
+                continue;
+            }
+            for (auto& count : group->counts) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+        slice.total.store(0, std::memory_order_relaxed);
+        slice.max.store(0, std::memory_order_relaxed);
+    }
+    return slice;
+}
+
+void LatencyHistogram::record(qint64 value_us, qint64 now_ms) {
+    if (value_us < 0) {
+        return;
+    }
+    const quint32 value = static_cast<quint32>(qMin<qint64>(value_us, 0xFFFFFFFF));
+    Slice& slice = LatencyHistogram::slice_for(now_ms);
+    const int bucket = LatencyHistogram::bucket_of(value);
+    LatencyHistogram::group_of(slice, bucket)->counts[bucket % SUB_HALF].fetch_add(1, std::memory_order_relaxed);
+    slice.total.fetch_add(1, std::memory_order_relaxed);
+
+    quint32 max = slice.max.load(std::memory_order_relaxed);
+    while (value > max && !slice.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+/*Allocates the group of the bucket with its first record*/
+LatencyHistogram::Group* LatencyHistogram::group_of(Slice& slice, int bucket) {
+    std::atomic<Group*>& group_ptr = slice.groups[bucket / static_cast<int>(SUB_HALF)];
+    Group* group = group_ptr.load(std::memory_order_acquire);
+    if (group) {
+        return group;
+    }
+    Group* fresh = new Group;
+    for (auto& count : fresh->counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    if (group_ptr.compare_exchange_strong(group, fresh, std::memory_order_acq_rel)) {
+        return fresh;
+    }
+    delete fresh;
+    return group;
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary(qint64 now_ms) const {
+    Summary summary;
+    const qint64 window = m_window_ms > 0 ? now_ms / m_window_ms : 0;
+
+    const Slice* slices = m_slices.load(std::memory_order_acquire);
+    if (!slices) {
+        return summary;
+    }
+
+    //Only slices of the current and the previous window are counted
+    const Slice* used[2] = {nullptr, nullptr};
+    quint32 max = 0;
+    for (int s = 0; s < m_slice_count; ++s) {
+        const qint64 slice_window = slices[s].window.load(std::memory_order_acquire);
+        if (m_window_ms > 0 && (slice_window < window - 1 || slice_window > window)) {
+            continue;
+        }
+        used[s] = &slices[s];
+        summary.count += slices[s].total.load(std::memory_order_relaxed);
+        max = qMax(max, slices[s].max.load(std::memory_order_relaxed));
+    }
+    summary.max_us = max;
+    if (summary.count == 0) {
+        return summary;
+    }
+    //The count only grows within the windows, so an equal count means equal buckets
+    if (window == m_summary_window && summary.count == m_summary.count && summary.max_us == m_summary.max_us) {
+        return m_summary;
+    }
+
+    const quint64 rank_p50 = (summary.count * 500 + 999) / 1000;
+    const quint64 rank_p99 = (summary.count * 990 + 999) / 1000;
+    const quint64 rank_p999 = (summary.count * 999 + 999) / 1000;
+    quint64 seen = 0;
+    bool done = false;
+    for (int g = 0; g < GROUP_COUNT && !done; ++g) {
+        const Group* groups[2] = {nullptr, nullptr};
+        for (int s = 0; s < 2; ++s) {
+            if (used[s]) {
+                groups[s] = used[s]->groups[g].load(std::memory_order_acquire);
+            }
+        }
+        if (!groups[0] && !groups[1]) {
+            continue;
+        }
+        for (int offset = 0; offset < static_cast<int>(SUB_HALF); ++offset) {
+            for (const Group* group : groups) {
+                if (group) {
+                    seen += group->counts[offset].load(std::memory_order_relaxed);
+                }
+            }
+            if (seen == 0) {
+                continue;
+            }
+            const int bucket = g * static_cast<int>(SUB_HALF) + offset;
+            const qint64 value = qMin<qint64>(LatencyHistogram::value_of(bucket), summary.max_us);
+            if (summary.p50_us == 0 && seen >= rank_p50) summary.p50_us = value;
+            if (summary.p99_us == 0 && seen >= rank_p99) summary.p99_us = value;
+            if (seen >= rank_p999) {
+                summary.p999_us = value;
+                done = true;
+                break;
+            }
+        }
+    }
+    m_summary = summary;
+    m_summary_window = window;
+    return summary;
+}
+
+LatencyHistogram* LatencyRegistry::histogram(quint32 server_id, quint32 target_id) {
+    if (m_histograms.size() <= server_id) {
+        m_histograms.resize(server_id + 1);
+    }
+    auto& by_target = m_histograms[server_id];
+    if (by_target.size() <= target_id) {
+        by_target.resize(target_id + 1);
+    }
+    if (!by_target[target_id]) {
+        by_target[target_id] = std::make_unique<LatencyHistogram>(m_window_ms);
+    }
+    return by_target[target_id].get();
+}
+
+const LatencyHistogram* LatencyRegistry::find(quint32 server_id, quint32 target_id) const {
+    if (server_id >= m_histograms.size() || target_id >= m_histograms[server_id].size()) {
+        return nullptr;
+    }
+    return m_histograms[server_id][target_id].get();
+}
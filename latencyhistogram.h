@@ -0,0 +1,111 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Round-trip-time histograms in the style of HdrHistogram. Values are
+ * recorded in microseconds into log-linear buckets (16 sub-buckets per
+ * power of two, so every percentile is within 3.2% of the real value).
+ * The buckets of one power of two form a group, which is allocated with
+ * its first record. The RTTs of a target span only a few powers of two,
+ * so a histogram holds a few hundred bytes, and nothing for a target
+ * which never answered. Recording is a relaxed atomic increment and
+ * never blocks, so the tracker can record while the display reads.
+ * With a window the histogram keeps two slices, the percentiles then
+ * cover the last one to two windows.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+
+class LatencyHistogram {
+
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr quint32 SUB_COUNT = 1u << SUB_BITS;
+    static constexpr quint32 SUB_HALF = SUB_COUNT / 2;
+    //Values up to 2^32 us (about 71 minutes), larger ones are clamped
+    static constexpr int BUCKET_COUNT = (32 - SUB_BITS + 1) * SUB_HALF + SUB_HALF;
+    static constexpr int GROUP_COUNT = BUCKET_COUNT / static_cast<int>(SUB_HALF);
+
+    struct Summary {
+        quint64 count = 0;
+        qint64 p50_us = 0;
+        qint64 p99_us = 0;
+        qint64 p999_us = 0;
+        qint64 max_us = 0;
+    };
+
+    explicit LatencyHistogram(qint64 window_ms = 0);
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(qint64 value_us, qint64 now_ms);
+    //Only called on the main-thread, recomputed only if lookups were recorded since the last call
+    Summary summary(qint64 now_ms) const;
+
+    static int bucket_of(quint32 value_us);
+    static qint64 value_of(int bucket);
+
+private:
+    struct Group {
+        std::atomic<quint32> counts[SUB_HALF];
+    };
+
+    struct Slice {
+        //Groups are never freed before the histogram, a reader may hold one
+        std::atomic<Group*> groups[GROUP_COUNT];
+        std::atomic<quint64> total{0};
+        std::atomic<quint32> max{0};
+        std::atomic<qint64> window{-1};
+
+        Slice();
+        ~Slice();
+    };
+
+    qint64 m_window_ms;
+    //Allocated with the first record, readers see nullptr before
+    std::atomic<Slice*> m_slices{nullptr};
+    int m_slice_count;
+
+    //Last summary with the count and window it was computed for
+    mutable Summary m_summary;
+    mutable qint64 m_summary_window = -1;
+
+    Slice* slices_for_record();
+    Slice& slice_for(qint64 now_ms);
+    static Group* group_of(Slice& slice, int bucket);
+};
+
+/*Histograms per (server id, target id). They are created while the
+  trackers are set up, afterwards the registry itself is read-only*/
+class LatencyRegistry {
+
+public:
+    explicit LatencyRegistry(qint64 window_ms = 0) : m_window_ms(window_ms) {}
+
+    LatencyHistogram* histogram(quint32 server_id, quint32 target_id);
+    const LatencyHistogram* find(quint32 server_id, quint32 target_id) const;
+
+private:
+    qint64 m_window_ms;
+    std::vector<std::vector<std::unique_ptr<LatencyHistogram>>> m_histograms;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,405 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The loadtest.cpp drives the tracker-pool with N names on M servers
+ * against the mock-responder, which runs on its own thread on
+ * 127.0.0.1 ... 127.0.0.M. Every generated answer changes once at
+ * --change-at, so the time until each tracker counts the change is its
+ * detection-delay.
+ * Reported as JSON: queries per second, CPU per query of the trackers
+ * (process-CPU without the responder-thread), detection-delays and the
+ * growth of the resident memory.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <getopt.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QMetaObject>
+#include <QThread>
+#include <QTimer>
+
+#include "dnstracker.h"
+#include "display.h"
+#include "dnswire.h"
+#include "metricsserver.h"
+#include "mockresponder.h"
+#include "trackerpool.h"
+
+namespace {
+
+struct LoadOptions {
+    int targets = 1000;
+    int servers = 4;
+    quint16 port = 5353;
+    double interval = 1;
+    double duration = 20;
+    //-1: half of the duration
+    double change_at = -1;
+    int threads = 0;
+    bool batched_io = false;
+    int latency_ms = 0;
+    int jitter_ms = 0;
+    double loss = 0;
+    quint32 ttl = 60;
+    int records = 1;
+    std::string output;
+};
+
+struct LoadResult {
+    quint64 queries = 0;
+    quint64 responses = 0;
+    quint64 errors = 0;
+    quint64 timeouts = 0;
+    double seconds = 0;
+    qint64 process_cpu_us = 0;
+    qint64 responder_cpu_us = 0;
+    std::vector<qint64> delays_ms;
+    qint64 rss_start = 0;
+    qint64 rss_end = 0;
+    qint64 rss_peak = 0;
+};
+
+/*Swallows the frames of the display*/
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+qint64 cpu_us(int who) {
+    struct rusage usage;
+    if (getrusage(who, &usage) != 0) {
+        return 0;
+    }
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/*Resident memory in bytes, 0 if /proc is not available*/
+qint64 rss_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    qint64 size = 0;
+    qint64 resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+qint64 percentile(const std::vector<qint64>& sorted, double p) {
+    if (sorted.empty()) {
+        return -1;
+    }
+    const size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void write_json(std::ostream& out, const LoadOptions& opts, const LoadResult& r, int trackers) {
+    std::vector<qint64> delays = r.delays_ms;
+    std::sort(delays.begin(), delays.end());
+    const qint64 tracker_cpu_us = r.process_cpu_us - r.responder_cpu_us;
+
+    out << "{\n  \"scenario\": {\"targets\": " << opts.targets << ", \"servers\": " << opts.servers
+        << ", \"trackers\": " << trackers << ", \"interval_sec\": " << opts.interval
+        << ", \"duration_sec\": " << opts.duration << ", \"change_at_sec\": " << opts.change_at
+        << ", \"threads\": " << opts.threads << ", \"latency_ms\": " << opts.latency_ms
+        << ", \"jitter_ms\": " << opts.jitter_ms << ", \"loss\": " << opts.loss << ", \"records\": " << opts.records << "},\n";
+    out << "  \"queries\": {\"sent\": " << r.queries << ", \"responses\": " << r.responses
+        << ", \"errors\": " << r.errors << ", \"timeouts\": " << r.timeouts
+        << ", \"per_sec\": " << (r.seconds > 0 ? r.queries / r.seconds : 0) << "},\n";
+    out << "  \"cpu\": {\"tracker_us\": " << tracker_cpu_us << ", \"responder_us\": " << r.responder_cpu_us
+        << ", \"tracker_us_per_query\": " << (r.queries > 0 ? static_cast<double>(tracker_cpu_us) / r.queries : 0) << "},\n";
+    out << "  \"detection\": {\"detected\": " << delays.size() << ", \"total\": " << trackers
+        << ", \"p50_ms\": " << percentile(delays, 0.5) << ", \"p99_ms\": " << percentile(delays, 0.99)
+        << ", \"max_ms\": " << (delays.empty() ? -1 : delays.back()) << "},\n";
+    out << "  \"memory\": {\"rss_start\": " << r.rss_start << ", \"rss_end\": " << r.rss_end
+        << ", \"rss_peak\": " << r.rss_peak << ", \"rss_growth\": " << r.rss_end - r.rss_start << "}\n}\n";
+}
+
+void print_help() {
+    std::cout << "Usage: dns_tracker_load [OPTION]" << std::endl;
+    std::cout << "\t--targets=N (names per server, default 1000)" << std::endl;
+    std::cout << "\t--servers=M (mock-servers 127.0.0.1 ... 127.0.0.M, default 4)" << std::endl;
+    std::cout << "\t--port=PORT (port of the mock-servers, default 5353)" << std::endl;
+    std::cout << "\t--interval=SEC (poll-interval of every tracker, default 1)" << std::endl;
+    std::cout << "\t--duration=SEC (runtime, default 20)" << std::endl;
+    std::cout << "\t--change-at=SEC (all answers change after SEC seconds, default half of the duration)" << std::endl;
+    std::cout << "\t--threads=N (worker-threads, default one per core)" << std::endl;
+    std::cout << "\t--io=batched (batched sends of the native backend)" << std::endl;
+    std::cout << "\t--latency=MS, --jitter=MS, --loss=P (simulated by the mock-servers)" << std::endl;
+    std::cout << "\t--ttl=SEC (TTL of the answers, default 60)" << std::endl;
+    std::cout << "\t--records=N (A-records per answer, default 1, must fit into one EDNS-reply)" << std::endl;
+    std::cout << "\t--out=FILEPATH (write the JSON-result to a file instead of stdout)" << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    LoadOptions opts;
+    static struct option long_opts[] = {
+        {"targets", required_argument, nullptr, 'n'},
+        {"servers", required_argument, nullptr, 'm'},
+        {"port", required_argument, nullptr, 'p'},
+        {"interval", required_argument, nullptr, 'i'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"change-at", required_argument, nullptr, 'c'},
+        {"threads", required_argument, nullptr, 'T'},
+        {"io", required_argument, nullptr, 'I'},
+        {"latency", required_argument, nullptr, 'l'},
+        {"jitter", required_argument, nullptr, 'j'},
+        {"loss", required_argument, nullptr, 'x'},
+        {"ttl", required_argument, nullptr, 't'},
+        {"records", required_argument, nullptr, 'r'},
+        {"out", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:h", long_opts, nullptr)) != -1) {
+        try {
+            switch (opt) {
+            case 'n':
+                opts.targets = std::stoi(optarg);
+                break;
+            case 'm':
+                opts.servers = std::stoi(optarg);
+                break;
+            case 'p': {
+                const int port = std::stoi(optarg);
+                if (port <= 0 || port > 65535) throw std::invalid_argument("out of range");
+                opts.port = static_cast<quint16>(port);
+                break;
+            }
+            case 'i':
+                opts.interval = std::stod(optarg);
+                break;
+            case 'd':
+                opts.duration = std::stod(optarg);
+                break;
+            case 'c':
+                opts.change_at = std::stod(optarg);
+                break;
+            case 'T':
+                opts.threads = std::stoi(optarg);
+                break;
+            case 'I':
+                if (std::string(optarg) != "batched") throw std::invalid_argument("unknown mode");
+                opts.batched_io = true;
+                break;
+            case 'l':
+                opts.latency_ms = std::stoi(optarg);
+                break;
+            case 'j':
+                opts.jitter_ms = std::stoi(optarg);
+                break;
+            case 'x':
+                opts.loss = std::stod(optarg);
+                break;
+            case 't':
+                opts.ttl = static_cast<quint32>(std::stoul(optarg));
+                break;
+            case 'r':
+                opts.records = std::stoi(optarg);
+                if (opts.records <= 0) throw std::invalid_argument("non-positive value");
+                break;
+            case 'o':
+                opts.output = optarg;
+                break;
+            case 'h':
+                print_help();
+                return 0;
+            default:
+                print_help();
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Unsupported value: " << optarg << std::endl;
+            return 1;
+        }
+    }
+
+    if (opts.change_at < 0) {
+        opts.change_at = opts.duration / 2;
+    }
+    if (opts.targets <= 0 || opts.servers <= 0 || opts.servers > 254) {
+        std::cerr << "Targets must be positive and servers between 1 and 254" << std::endl;
+        return 1;
+    }
+    if (opts.interval <= 0 || opts.change_at <= opts.interval || opts.change_at >= opts.duration) {
+        std::cerr << "The change must come after the first interval and before the end of the duration" << std::endl;
+        return 1;
+    }
+
+    //Truncated replies are errors of the native backend, the run would measure them instead of the tracking
+    const QString longest_name = QString("t%1.load.test").arg(opts.targets - 1);
+    if (MockResponder::a_answer_size(longest_name, opts.records) > DnsWire::EDNS_UDP_SIZE) {
+        std::cerr << "Answers with " << opts.records << " records exceed the EDNS-size of "
+                  << DnsWire::EDNS_UDP_SIZE << " bytes and would be truncated" << std::endl;
+        return 1;
+    }
+
+    QCoreApplication app(argc, argv);
+    LoadResult result;
+    result.rss_start = rss_bytes();
+
+    //The responder gets its own thread, so its CPU can be told apart from the trackers
+    MockResponder::Settings settings;
+    settings.port = opts.port;
+    settings.answers.ttl = opts.ttl;
+    settings.answers.records = opts.records;
+    settings.answers.change_at_ms = static_cast<qint64>(opts.change_at * 1000);
+    settings.latency_ms = opts.latency_ms;
+    settings.jitter_ms = opts.jitter_ms;
+    settings.loss = opts.loss;
+    QList<QHostAddress> addresses;
+    for (int s = 1; s <= opts.servers; ++s) {
+        addresses.append(QHostAddress(QString("127.0.0.%1").arg(s)));
+    }
+
+    QThread responder_thread;
+    responder_thread.setObjectName("mock-responder");
+    auto responder = new MockResponder(settings);
+    responder->moveToThread(&responder_thread);
+    QObject::connect(&responder_thread, &QThread::finished, responder, &QObject::deleteLater);
+    responder_thread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(responder, [responder, &addresses, &listening]() {
+        listening = responder->listen(addresses);
+    }, Qt::BlockingQueuedConnection);
+    if (!listening) {
+        responder_thread.quit();
+        responder_thread.wait();
+        return 1;
+    }
+    const qint64 change_time_ms = DnsTracker::current_time_ms() + settings.answers.change_at_ms;
+
+    Options display_opts;
+    display_opts.max_fps = 1;
+    NullBuffer null_buffer;
+    std::streambuf* original = std::cout.rdbuf(&null_buffer);
+    auto display = new Display(DnsTracker::current_time_ms(), display_opts, &app);
+
+    //The metrics are owned here, every tracker counts into its own
+    const int trackers = opts.targets * opts.servers;
+    std::vector<std::unique_ptr<TargetMetrics>> metrics;
+    metrics.reserve(static_cast<size_t>(trackers));
+    QList<TrackerTarget> targets;
+    targets.reserve(trackers);
+    for (int n = 0; n < opts.targets; ++n) {
+        for (int s = 0; s < opts.servers; ++s) {
+            TrackerTarget target;
+            Options& target_opts = target.options;
+            target_opts.dns_type = "A";
+            target_opts.record_type = QDnsLookup::A;
+            target_opts.dns_name = QString("t%1.load.test").arg(n);
+            target_opts.dns_server = addresses.at(s).toString();
+            target_opts.dns_port = opts.port;
+            target_opts.server_id = static_cast<quint32>(s);
+            target_opts.target_id = static_cast<quint32>(n);
+            target_opts.sleep_intervall = static_cast<size_t>(opts.interval * 1000);
+            target_opts.start_spread = target_opts.sleep_intervall;
+            target_opts.continue_measurment = true;
+            target_opts.multi_requests = true;
+            target_opts.native_backend = true;
+            target_opts.batched_io = opts.batched_io;
+
+            metrics.push_back(std::make_unique<TargetMetrics>());
+            target.metrics = metrics.back().get();
+            target.latency = display->latency()->histogram(target_opts.server_id, target_opts.target_id);
+            targets.append(target);
+        }
+    }
+
+    auto pool = new TrackerPool(display, &app);
+    if (!pool->start(targets, opts.threads)) {
+        pool->stop();
+        std::cout.rdbuf(original);
+        responder_thread.quit();
+        responder_thread.wait();
+        return 1;
+    }
+    opts.threads = pool->thread_count();
+
+    //First time a tracker counts the change, -1 until then
+    std::vector<qint64> detected_ms(static_cast<size_t>(trackers), -1);
+    qint64 responder_start_us = 0;
+    QMetaObject::invokeMethod(responder, [&responder_start_us]() {
+        responder_start_us = cpu_us(RUSAGE_THREAD);
+    }, Qt::BlockingQueuedConnection);
+    const qint64 start_cpu_us = cpu_us(RUSAGE_SELF);
+    const qint64 start_ms = DnsTracker::current_time_ms();
+    QTimer sampler;
+    QObject::connect(&sampler, &QTimer::timeout, &app, [&]() {
+        const qint64 now_ms = DnsTracker::current_time_ms();
+        if (now_ms >= change_time_ms) {
+            for (size_t i = 0; i < metrics.size(); ++i) {
+                if (detected_ms[i] < 0 && metrics[i]->changes.load(std::memory_order_relaxed) > 0) {
+                    detected_ms[i] = now_ms;
+                }
+            }
+        }
+        result.rss_peak = qMax(result.rss_peak, rss_bytes());
+    });
+    sampler.start(10);
+    QTimer::singleShot(static_cast<int>(opts.duration * 1000), &app, &QCoreApplication::quit);
+
+    app.exec();
+    sampler.stop();
+    result.seconds = static_cast<double>(DnsTracker::current_time_ms() - start_ms) / 1000.0;
+    result.process_cpu_us = cpu_us(RUSAGE_SELF) - start_cpu_us;
+    QMetaObject::invokeMethod(responder, [&result, responder_start_us]() {
+        result.responder_cpu_us = cpu_us(RUSAGE_THREAD) - responder_start_us;
+    }, Qt::BlockingQueuedConnection);
+    pool->stop();
+    responder_thread.quit();
+    responder_thread.wait();
+    std::cout.rdbuf(original);
+
+    for (const auto& target : metrics) {
+        result.queries += target->queries_sent.load(std::memory_order_relaxed);
+        result.responses += target->responses.load(std::memory_order_relaxed);
+        result.errors += target->errors.load(std::memory_order_relaxed);
+        result.timeouts += target->timeouts.load(std::memory_order_relaxed);
+    }
+    //The servers see the change one after the other only with a stagger, here all at once
+    for (qint64 time_ms : detected_ms) {
+        if (time_ms >= 0) {
+            result.delays_ms.push_back(time_ms - change_time_ms);
+        }
+    }
+    result.rss_end = rss_bytes();
+    result.rss_peak = qMax(result.rss_peak, result.rss_end);
+
+    if (opts.output.empty()) {
+        write_json(std::cout, opts, result, trackers);
+    } else {
+        std::ofstream file(opts.output);
+        if (!file) {
+            std::cerr << "File could not be opended: " << opts.output << std::endl;
+            return 1;
+        }
+        write_json(file, opts, result, trackers);
+    }
+    return 0;
+}
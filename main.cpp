@@ -16,7 +16,12 @@
 ********************************************************************/
 
 #include <iostream>
+#include <memory>
+#include <vector>
+#include <cstring>
 #include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
 
 #include <QCoreApplication>
 #include <QTimer>
@@ -24,21 +29,192 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QHostAddress>
+#include <QSocketNotifier>
+#include <QElapsedTimer>
 
 #include "dnstracker.h"
 #include "display.h"
+#include "hashing.h"
+#include "historylog.h"
+#include "replay.h"
+#include "metricsserver.h"
+#include "trackerpool.h"
+#include "ratelimiter.h"
+#include "recordtraits.h"
+#include "targetfile.h"
+#include "simulation.h"
+#include "convergence.h"
+#include "tracing.h"
+#include "dnswire.h"
+
+static int s_quit_pipe[2] = {-1, -1};
+
+static void handle_quit_signal(int) {
+    char c = 1;
+    ssize_t written = ::write(s_quit_pipe[1], &c, 1);
+    (void)written;
+}
+
+/*STRG+C leaves the event-loop regularly, so the export is flushed before exit*/
+static QSocketNotifier* install_quit_handler(QCoreApplication* app) {
+    if (::pipe(s_quit_pipe) != 0) {
+        return nullptr;
+    }
+    auto notifier = new QSocketNotifier(s_quit_pipe[0], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [app]() {
+        app->quit();
+    });
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_quit_signal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    return notifier;
+}
+
+static int s_trace_pipe[2] = {-1, -1};
+
+static void handle_trace_signal(int) {
+    char c = 1;
+    ssize_t written = ::write(s_trace_pipe[1], &c, 1);
+    (void)written;
+}
+
+/*SIGUSR1 dumps the trace-rings, the file is written on the main-thread and not in the signal-handler*/
+static void install_trace_handler(QCoreApplication* app, const QString& filepath) {
+    if (::pipe(s_trace_pipe) != 0) {
+        return;
+    }
+    auto notifier = new QSocketNotifier(s_trace_pipe[0], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [filepath]() {
+        char c;
+        ssize_t got = ::read(s_trace_pipe[0], &c, 1);
+        (void)got;
+        if (Tracing::dump(filepath)) {
+            std::cerr << "Trace written: " << filepath.toStdString() << std::endl;
+        }
+    });
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_trace_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, nullptr);
+}
+
+/*Checks a export-path given on the command-line, without a path the file is placed in $HOME*/
+static bool resolve_export_path(const char* arg, const char* default_name, QString& filepath) {
+    if (arg != nullptr) {
+        QString path = QString::fromUtf8(arg);
+        QFileInfo file(path);
+
+        if (file.fileName().isEmpty()) {
+            std::cerr << "Invalid export-path: No filename specified - " << arg << std::endl;
+            return false;
+        }
+
+        QDir directory = file.dir();
+        if (!directory.exists()) {
+            std::cerr << "Invalid export-path: directory does not exist - " << directory.absolutePath().toStdString() << std::endl;
+            return false;
+        }
+
+        if (file.exists()) {
+            std::cerr << "Invalid export-path: file does already exist - " << file.absoluteFilePath().toStdString() << std::endl;
+            return false;
+        }
+        filepath = file.absoluteFilePath();
+        return true;
+    }
+
+    const char* home = getenv("HOME");
+    if (home == nullptr) {
+        std::cerr << "No valid home-path found, please check the env-variables" << std::endl;
+        return false;
+    }
+    filepath = QString::fromUtf8(home) + "/" + default_name;
+
+    QFileInfo file(filepath);
+    if (file.exists()) {
+        std::cerr << "Invalid export-path: file does already exists - " << file.absoluteFilePath().toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*Replay-mode: a recorded history-log is fed into the display instead of live lookups*/
+static int run_replay(QCoreApplication& app, const Options& opts) {
+    HistoryReader reader;
+    if (!reader.open(opts.replay_filepath)) {
+        std::cerr << reader.error_string().toStdString() << std::endl;
+        return 1;
+    }
+
+    HistoryReader::Observation first;
+    qint64 start_time = 0;
+    if (reader.next(first)) {
+        start_time = first.time_ms;
+    }
+
+    auto display = new Display(start_time, opts, &app);
+    auto replayer = new Replayer(&reader, display, opts.replay_speed, &app);
+    QObject::connect(replayer, &Replayer::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+    QTimer::singleShot(0, replayer, &Replayer::start);
+
+    int result = app.exec();
+    //Display owns the exporters, they have to be flushed while the reader is still mapped
+    delete display;
+    std::cout << "Replayed observations: " << replayer->replayed() << std::endl;
+    return result;
+}
 
 void print_help() {
     std::cout << "DNS-Tracker v1.4" << std::endl;
-    std::cout << "Usage: dns_tracker -t [TYPE] -s [IP] -n [NAME] [OPTION]" << std::endl;
+    std::cout << "Usage: dns_tracker -t [TYPE] -s [IP ...] -n [NAME ...] [OPTION]" << std::endl;
+    std::cout << "       dns_tracker --targets=FILEPATH [OPTION]" << std::endl;
     std::cout << "In standard-mode an dns-request is issued and the answer displayed." << std::endl;
     std::cout << "If -c for continues measurment is activated the same request will be send every 60 seconds until quit with STRG+C" << std::endl;
     std::cout << std::endl;
     std::cout << "Mandatory arguments are labled with *" << std::endl;
-    std::cout << "\t*-t DNS-TYPE (SRV, A)" << std::endl;
-    std::cout << "\t*-s DNS-SERVER (IP-address)" << std::endl;
-    std::cout << "\t*-n DNS-NAME" << std::endl;
+    std::cout << "\t*-t DNS-TYPE (A, AAAA, SRV, MX, TXT, CNAME, NS)" << std::endl;
+    std::cout << "\t*-s DNS-SERVER (one or more IP-addresses)" << std::endl;
+    std::cout << "\t*-n DNS-NAME (one or more names, every name is tracked at every server)" << std::endl;
+    std::cout << "\t--targets=FILEPATH (watchlist, one target per line: NAME TYPE SERVER [INTERVAL-SEC], -t, -s and -n are not needed)" << std::endl;
     std::cout << "\t--export=FILEPATH (for file-export)" << std::endl;
+    std::cout << "\t--fsync=POLICY (export-sync to disk: never, batch (default), always)" << std::endl;
+    std::cout << "\t--binary-export=FILEPATH (compact binary history-log, can be replayed with --replay)" << std::endl;
+    std::cout << "\t--replay=FILEPATH (replay a binary history-log into the display, -t, -s and -n are not needed)" << std::endl;
+    std::cout << "\t--replay-speed=X (replay X times faster than recorded, 0 as fast as possible, default 1)" << std::endl;
+    std::cout << "\t--flush-rows=N (write the export once N rows are queued, default 256)" << std::endl;
+    std::cout << "\t--flush-interval=MS (write the export at least every MS milliseconds, default 1000)" << std::endl;
+    std::cout << "\t--backend=BACKEND (qt: QDnsLookup per request (default), native: own wire-format engine with one socket per server)" << std::endl;
+    std::cout << "\t--dns-port=PORT (native backend only: port of the DNS-servers, default 53, e.g. for the dns_mock responder)" << std::endl;
+    std::cout << "\t--io=MODE (native backend only: single (default), mmsg: batched sendmmsg/recvmmsg, uring: batched io_uring-submit)" << std::endl;
+    std::cout << "\t--io-stats (print messages and syscalls of every I/O-batch to stderr)" << std::endl;
+    std::cout << "\t--hash=ALGO (fast: binary 128-bit hash (default), md5: hash of version 1.4 and older)" << std::endl;
+    std::cout << "\t--fps=N (redraw the display at most N times per second, default 10)" << std::endl;
+    std::cout << "\t--rtt-window=SEC (RTT-percentiles only cover the last SEC to 2*SEC seconds, default: whole run)" << std::endl;
+    std::cout << "\t--metrics=[ADDRESS:]PORT (serve OpenMetrics at http://ADDRESS:PORT/metrics, default address 127.0.0.1)" << std::endl;
+    std::cout << "\t--adaptive (continues-mode: back off while stable, but query again at the latest just after the TTL is over)" << std::endl;
+    std::cout << "\t--burst-interval=SEC (adaptive: interval of the queries right after a change, default 5)" << std::endl;
+    std::cout << "\t--max-interval=SEC (adaptive: longest interval between two queries, default 3600)" << std::endl;
+    std::cout << "\t--timeout=MS (a lookup without answer after MS milliseconds fails, default 5000)" << std::endl;
+    std::cout << "\t--retries=N (repeat a timed out or failed lookup N times, default 2)" << std::endl;
+    std::cout << "\t--retry-backoff=MS (wait before the first retry, doubled for every further one, default 1000)" << std::endl;
+    std::cout << "\t--rate-limit=QPS (queries per second to one DNS-server, default unlimited)" << std::endl;
+    std::cout << "\t--rate-burst=N (queries sent at once before the rate-limit applies, default 1)" << std::endl;
+    std::cout << "\t--max-in-flight=N (unanswered queries to one DNS-server, default unlimited)" << std::endl;
+    std::cout << "\t--threads=N (tracker-threads with own event-loop and sockets, default 0: one per core)" << std::endl;
+    std::cout << "\t--trace=FILEPATH (Chrome trace-events of the hot-path, written on SIGUSR1 and at exit, needs -DDNS_TRACKER_TRACING=ON)" << std::endl;
+    std::cout << "\t--simulate=DAYS (continues-mode in virtual time against scripted answers, as fast as possible)" << std::endl;
+    std::cout << "\t--converge[=QUORUM] (stop polling a target once all servers, or the share QUORUM of them, return a new answer, and report the propagation per server)" << std::endl;
+    std::cout << "\t--answers=FILEPATH (simulation: answers per line NAME A|SRV AT-SEC TTL VALUE..., default: every answer changes daily)" << std::endl;
     std::cout << "\t[-c SEC (continues-measurment, pulls request every 60 seconds if no value defined)]" << std::endl;
     std::cout << "\t[-v verbose-mode]" << std::endl;
     std::cout << "\t[-h show help]" << std::endl;
@@ -53,7 +229,36 @@ int main(int argc, char *argv[])
         {"dns_server", required_argument, nullptr, 's'},
         {"dns_name", required_argument, nullptr, 'n'},
         {"continue", optional_argument, nullptr, 'c'},
+        {"targets", required_argument, nullptr, 'G'},
+        {"simulate", required_argument, nullptr, 'V'},
+        {"answers", required_argument, nullptr, 'A'},
+        {"trace", required_argument, nullptr, 'Z'},
+        {"converge", optional_argument, nullptr, 'K'},
+        {"dns-port", required_argument, nullptr, 'D'},
         {"export", optional_argument, nullptr, 'e'},
+        {"binary-export", optional_argument, nullptr, 'B'},
+        {"replay", required_argument, nullptr, 'P'},
+        {"replay-speed", required_argument, nullptr, 'S'},
+        {"backend", required_argument, nullptr, 'b'},
+        {"io", required_argument, nullptr, 'i'},
+        {"io-stats", no_argument, nullptr, 'I'},
+        {"hash", required_argument, nullptr, 'H'},
+        {"fsync", required_argument, nullptr, 'F'},
+        {"flush-rows", required_argument, nullptr, 'R'},
+        {"flush-interval", required_argument, nullptr, 'T'},
+        {"fps", required_argument, nullptr, 'r'},
+        {"rtt-window", required_argument, nullptr, 'w'},
+        {"metrics", required_argument, nullptr, 'M'},
+        {"adaptive", no_argument, nullptr, 'a'},
+        {"burst-interval", required_argument, nullptr, 'u'},
+        {"max-interval", required_argument, nullptr, 'x'},
+        {"threads", required_argument, nullptr, 'N'},
+        {"timeout", required_argument, nullptr, 'O'},
+        {"retries", required_argument, nullptr, 'y'},
+        {"retry-backoff", required_argument, nullptr, 'Y'},
+        {"rate-limit", required_argument, nullptr, 'L'},
+        {"rate-burst", required_argument, nullptr, 'U'},
+        {"max-in-flight", required_argument, nullptr, 'Q'},
         {"verbose", no_argument, nullptr, 'v'},
         {"help", no_argument, nullptr, 'h'},
         {nullptr, 0, nullptr, 0}
@@ -67,17 +272,71 @@ int main(int argc, char *argv[])
             break;
         case 's':
             opts.multi_dns_server.push_back(optarg);
-            while (optind < argc && opts.multi_dns_server.size() <=5 && argv[optind][0] != '-') {
+            while (optind < argc && argv[optind][0] != '-') {
                 opts.multi_dns_server.push_back(argv[optind]);
                 ++optind;
             }
             break;
         case 'n':
-            opts.dns_name = optarg;
+            opts.multi_dns_name.push_back(optarg);
+            while (optind < argc && argv[optind][0] != '-') {
+                opts.multi_dns_name.push_back(argv[optind]);
+                ++optind;
+            }
             break;
         case 'v':
             opts.verbose = true;
             break;
+        case 'G':
+            opts.targets_filepath = QString::fromUtf8(optarg);
+            break;
+        case 'V':
+            try {
+                double days = std::stod(optarg);
+                if (days <= 0 || days > 3650) throw std::invalid_argument("out of range");
+                opts.simulate_ms = static_cast<qint64>(days * 24 * 3600 * 1000);
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported simulation-days: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'A':
+            opts.answers_filepath = QString::fromUtf8(optarg);
+            break;
+        case 'Z':
+            if (!Tracing::ENABLED) {
+                std::cerr << "--trace needs a build with -DDNS_TRACKER_TRACING=ON" << std::endl;
+                return 1;
+            }
+            opts.trace_filepath = QFileInfo(QString::fromUtf8(optarg)).absoluteFilePath();
+            if (!QFileInfo(opts.trace_filepath).dir().exists()) {
+                std::cerr << "Invalid trace-path: directory does not exist - " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'K':
+            opts.converge_quorum = 1.0;
+            if (optarg != nullptr) {
+                try {
+                    double quorum = std::stod(optarg);
+                    if (quorum <= 0 || quorum > 1) throw std::invalid_argument("out of range");
+                    opts.converge_quorum = quorum;
+                } catch (const std::exception& e) {
+                    std::cerr << "Unsupported quorum: " << optarg << std::endl;
+                    return 1;
+                }
+            }
+            break;
+        case 'D':
+            try {
+                int port = std::stoi(optarg);
+                if (port <= 0 || port > 65535) throw std::invalid_argument("out of range");
+                opts.dns_port = static_cast<quint16>(port);
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported DNS-port: " << optarg << std::endl;
+                return 1;
+            }
+            break;
         case 'c':
             if (optarg != nullptr) {
                 try {
@@ -92,43 +351,184 @@ int main(int argc, char *argv[])
             opts.continue_measurment = true;
             break;
         case 'e':
-            if (optarg != nullptr) {
-                QString path = QString::fromUtf8(optarg);
-                QFileInfo file(path);
-
-                if (file.fileName().isEmpty()) {
-                    std::cerr << "Invalid export-path: No filename specified - " << optarg << std::endl;
-                    return 1;
-                }
-
-                QDir directory = file.dir();
-                if (!directory.exists()) {
-                    std::cerr << "Invalid export-path: directory does not exist - " << directory.absolutePath().toStdString() << std::endl;
-                    return 1;
+            if (!resolve_export_path(optarg, "dns_tracker_output.csv", opts.filepath)) {
+                return 1;
+            }
+            opts.file_export = true;
+            break;
+        case 'B':
+            if (!resolve_export_path(optarg, "dns_tracker_history.dnslog", opts.binary_filepath)) {
+                return 1;
+            }
+            opts.binary_export = true;
+            break;
+        case 'P':
+            opts.replay_filepath = QString::fromUtf8(optarg);
+            break;
+        case 'S':
+            try {
+                opts.replay_speed = std::stod(optarg);
+                if (opts.replay_speed < 0) throw std::invalid_argument("negative value");
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported replay-speed: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'b':
+            if (QString::fromUtf8(optarg).toLower() == "native") {
+                opts.native_backend = true;
+            } else if (QString::fromUtf8(optarg).toLower() != "qt") {
+                std::cerr << "Unsupported backend: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'i': {
+            QString mode = QString::fromUtf8(optarg).toLower();
+            if (mode == "mmsg" || mode == "uring") {
+                opts.native_backend = true;
+                opts.batched_io = true;
+                opts.io_uring = mode == "uring";
+            } else if (mode != "single") {
+                std::cerr << "Unsupported I/O-mode: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        }
+        case 'I':
+            opts.io_stats = true;
+            break;
+        case 'H':
+            if (QString::fromUtf8(optarg).toLower() == "md5") {
+                opts.legacy_hash = true;
+            } else if (QString::fromUtf8(optarg).toLower() != "fast") {
+                std::cerr << "Unsupported hash-algorithm: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'F': {
+            QString policy = QString::fromUtf8(optarg).toLower();
+            if (policy == "never") {
+                opts.export_settings.fsync = CsvExporter::FsyncPolicy::Never;
+            } else if (policy == "batch") {
+                opts.export_settings.fsync = CsvExporter::FsyncPolicy::Batch;
+            } else if (policy == "always") {
+                opts.export_settings.fsync = CsvExporter::FsyncPolicy::Always;
+            } else {
+                std::cerr << "Unsupported fsync-policy: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        }
+        case 'R':
+        case 'T':
+            try {
+                int value = std::stoi(optarg);
+                if (value <= 0) throw std::invalid_argument("non-positive value");
+                if (opt == 'R') {
+                    opts.export_settings.flush_rows = static_cast<size_t>(value);
+                } else {
+                    opts.export_settings.flush_interval_ms = value;
                 }
-
-                if (file.exists()) {
-                    std::cerr << "Invalid export-path: file does already exist - " << file.absoluteFilePath().toStdString() << std::endl;
-                    return 1;
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported value for export-flush: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'r':
+            try {
+                opts.max_fps = std::stoi(optarg);
+                if (opts.max_fps <= 0 || opts.max_fps > 1000) throw std::invalid_argument("out of range");
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported frame-rate: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'w':
+            try {
+                int sec = std::stoi(optarg);
+                if (sec <= 0) throw std::invalid_argument("non-positive value");
+                opts.rtt_window_ms = static_cast<qint64>(sec) * 1000;
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported RTT-window: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'M': {
+            //[ADDRESS:]PORT, without address only the local host can scrape
+            QString listen = QString::fromUtf8(optarg);
+            int colon = listen.lastIndexOf(':');
+            opts.metrics_address = colon > 0 ? listen.left(colon) : QString("127.0.0.1");
+            if (opts.metrics_address.startsWith('[') && opts.metrics_address.endsWith(']')) {
+                opts.metrics_address = opts.metrics_address.mid(1, opts.metrics_address.size() - 2);
+            }
+            bool ok = false;
+            int port = listen.mid(colon + 1).toInt(&ok);
+            if (!ok || port <= 0 || port > 65535 || QHostAddress(opts.metrics_address).isNull()) {
+                std::cerr << "Unsupported metrics-endpoint: " << optarg << std::endl;
+                return 1;
+            }
+            opts.metrics_port = static_cast<quint16>(port);
+            break;
+        }
+        case 'a':
+            opts.adaptive_polling = true;
+            break;
+        case 'u':
+        case 'x':
+            try {
+                int sec = std::stoi(optarg);
+                if (sec <= 0) throw std::invalid_argument("non-positive value");
+                if (opt == 'u') {
+                    opts.burst_interval_ms = static_cast<qint64>(sec) * 1000;
+                } else {
+                    opts.max_interval_ms = static_cast<qint64>(sec) * 1000;
                 }
-                opts.filepath = file.absoluteFilePath();
-
-            } else {
-                const char* home = getenv("HOME");
-                if (home != nullptr) {
-                    opts.filepath = QString::fromUtf8(home) + "/dns_tracker_output.csv";
-
-                    QFileInfo file(opts.filepath);
-                    if (file.exists()) {
-                        std::cerr << "Invalid export-path: file does already exists - " << file.absoluteFilePath().toStdString() << std::endl;
-                        return 1;
-                    }
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported interval for adaptive polling: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'N':
+            try {
+                opts.threads = std::stoi(optarg);
+                if (opts.threads < 0) throw std::invalid_argument("negative value");
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported number of threads: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'O':
+        case 'y':
+        case 'Y':
+        case 'U':
+        case 'Q':
+            try {
+                int value = std::stoi(optarg);
+                if (value < 0 || ((opt == 'O' || opt == 'U') && value == 0)) throw std::invalid_argument("out of range");
+                if (opt == 'O') {
+                    opts.timeout_ms = value;
+                } else if (opt == 'y') {
+                    opts.retries = value;
+                } else if (opt == 'Y') {
+                    opts.retry_backoff_ms = value;
+                } else if (opt == 'U') {
+                    opts.rate_burst = value;
                 } else {
-                    std::cerr << "No valid home-path found, please check the env-variables" << std::endl;
-                    return 1;
+                    opts.max_in_flight = value;
                 }
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported value for lookup-limits: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'L':
+            try {
+                opts.rate_limit = std::stod(optarg);
+                if (opts.rate_limit < 0) throw std::invalid_argument("negative value");
+            } catch (const std::exception& e) {
+                std::cerr << "Unsupported rate-limit: " << optarg << std::endl;
+                return 1;
             }
-            opts.file_export = true;
             break;
         case 'h':
             opts.show_help = true;
@@ -140,52 +540,240 @@ int main(int argc, char *argv[])
         }
     }
 
-    //Input-Validierung
-    if (opts.show_help || opts.dns_type.isEmpty() || opts.dns_name.isEmpty() || opts.multi_dns_server.empty()) {
+    Hashing::set_algorithm(opts.legacy_hash ? Hashing::Algorithm::Md5 : Hashing::Algorithm::Fast128);
+
+    if (!opts.replay_filepath.isEmpty() && !opts.show_help) {
+        QCoreApplication app(argc, argv);
+        install_quit_handler(&app);
+        return run_replay(app, opts);
+    }
+
+    //Simulation: continues-mode in virtual time, the trackers stay on the main-thread which drives the clock
+    if (!opts.answers_filepath.isEmpty() && opts.simulate_ms == 0) {
+        std::cerr << "--answers needs --simulate" << std::endl;
+        return 1;
+    }
+    if (opts.simulate_ms > 0) {
+        opts.continue_measurment = true;
+        opts.threads = 1;
+    }
+
+    if (opts.converge_quorum > 0 && !opts.continue_measurment) {
+        std::cerr << "--converge needs continues-mode (-c)" << std::endl;
+        return 1;
+    }
+
+    //Input-Validierung, with a target-file the targets of the command-line are optional
+    const bool cli_targets = !opts.dns_type.isEmpty() || !opts.multi_dns_name.empty() || !opts.multi_dns_server.empty();
+    const bool cli_complete = !opts.dns_type.isEmpty() && !opts.multi_dns_name.empty() && !opts.multi_dns_server.empty();
+    if (opts.show_help || ((cli_targets || opts.targets_filepath.isEmpty()) && !cli_complete)) {
         print_help();
         return !opts.show_help;
     }
-    if (opts.multi_dns_server.size() > 1) {
-        opts.multi_requests = true;
-    }
-    if (opts.dns_type.toUpper() != "SRV" && opts.dns_type.toUpper() != "A") {
+    //Resolved once, trackers and the pipeline behind them work on the enum only
+    if (cli_targets && !parse_record_type(opts.dns_type, opts.record_type)) {
         std::cerr << "Unsupported DNS-type: " << opts.dns_type.toUpper().toStdString() << std::endl;
         print_help();
         return 1;
     }
 
+    //Every name is tracked at every server of the command-line, the target-file adds its own targets
+    QList<TargetEntry> entries;
+    for (const auto& name : opts.multi_dns_name) {
+        for (const auto& server : opts.multi_dns_server) {
+            entries.append({name, server, opts.record_type, -1});
+        }
+    }
+    if (!opts.targets_filepath.isEmpty()) {
+        QElapsedTimer load_clock;
+        load_clock.start();
+        TargetFile target_file;
+        if (!target_file.load(opts.targets_filepath)) {
+            return 1;
+        }
+        entries.append(target_file.entries());
+        if (opts.verbose) {
+            std::cerr << "Target-file: " << target_file.entries().size() << " targets loaded in "
+                      << load_clock.elapsed() << " ms" << std::endl;
+        }
+    }
+    //A repeated line or option would run a second tracker on the same ids, the first one is kept
+    QSet<QPair<QPair<QString, int>, QString>> seen_entries;
+    QList<TargetEntry> unique_entries;
+    unique_entries.reserve(entries.size());
+    for (const auto& entry : entries) {
+        const auto key = qMakePair(qMakePair(entry.name, static_cast<int>(entry.type)), entry.server);
+        if (!seen_entries.contains(key)) {
+            seen_entries.insert(key);
+            unique_entries.append(entry);
+        }
+    }
+    if (unique_entries.size() < entries.size()) {
+        std::cerr << "Duplicate targets ignored: " << entries.size() - unique_entries.size() << std::endl;
+    }
+    entries = unique_entries;
+    if (entries.isEmpty()) {
+        std::cerr << "No targets to track" << std::endl;
+        return 1;
+    }
+    if (entries.size() > 1) {
+        opts.multi_requests = true;
+    }
+
     //Using Qt-Event-Loop only because of the conviniend QLookUp-Class
     QCoreApplication app(argc, argv);
+    QSocketNotifier* quit_notifier = install_quit_handler(&app);
+    if (!opts.trace_filepath.isEmpty()) {
+        install_trace_handler(&app, opts.trace_filepath);
+    }
 
-    QList<QString> dns_server = opts.multi_dns_server;
-    auto active_trackers = std::make_shared<size_t>(dns_server.size());
-    auto app_ptr = &app;
-    QString start_time = QDateTime::currentDateTime().toString(Qt::ISODate);
+    //The virtual clock has to be installed before the display, schedulers and limiters read the time
+    std::unique_ptr<Simulation> simulation;
+    if (opts.simulate_ms > 0) {
+        simulation = std::make_unique<Simulation>(QDateTime::currentMSecsSinceEpoch(), opts.simulate_ms);
+        if (!opts.answers_filepath.isEmpty() && !simulation->load_answers(opts.answers_filepath)) {
+            return 1;
+        }
+        if (quit_notifier) {
+            QObject::connect(quit_notifier, &QSocketNotifier::activated, &app, [&simulation]() {
+                simulation->stop();
+            });
+        }
+    }
+
+    qint64 start_time = DnsTracker::current_time_ms();
     auto display = new Display(start_time, opts);
     display->setParent(&app);
+    Convergence* convergence = nullptr;
+    if (opts.converge_quorum > 0) {
+        convergence = new Convergence(opts.converge_quorum, &app);
+        display->attach_convergence(convergence);
+    }
 
-    for (const auto& server : dns_server) {
-        Options server_opts = opts;
-        server_opts.dns_server = server;
+    //The targets of one worker share its timer-wheel, with more than one target their start is spread over one interval
+    if (opts.multi_requests) {
+        opts.start_spread = opts.sleep_intervall;
+    }
 
-        auto tracker = new DnsTracker(server_opts, &app);
+    MetricsServer* metrics = nullptr;
+    if (opts.metrics_port != 0) {
+        metrics = new MetricsServer(display, &app);
+        if (!metrics->listen(QHostAddress(opts.metrics_address), opts.metrics_port)) {
+            return 1;
+        }
+    }
 
-        QObject::connect(tracker, &DnsTracker::finished, tracker, [active_trackers, app_ptr]() mutable {
-            (*active_trackers)--;
-            if (*active_trackers == 0) {
-                app_ptr->quit();
+    if (opts.dns_port != DnsWire::DNS_PORT && !opts.native_backend) {
+        std::cerr << "--dns-port needs the native backend" << std::endl;
+        return 1;
+    }
+    if (opts.native_backend) {
+        for (const auto& server : opts.multi_dns_server) {
+            if (QHostAddress(server).isNull()) {
+                std::cerr << "Invalid DNS-server: " << server.toStdString() << std::endl;
+                return 1;
             }
-        });
-        if (server_opts.dns_type.toUpper() == "SRV") {
-            QObject::connect(tracker, &DnsTracker::send_srv_update, display, &Display::update_srv_display);
-        } else if (server_opts.dns_type.toUpper() == "A") {
-            QObject::connect(tracker, &DnsTracker::send_a_update, display, &Display::update_a_display);
         }
+    }
 
-        QTimer::singleShot(0, tracker, [tracker]() {
-            tracker->start();
-        });
+    //Rate-limit and in-flight cap are per server, shared by its trackers on all threads
+    std::vector<std::unique_ptr<RateLimiter>> limiters;
+    QHash<QString, RateLimiter*> server_limiters;
+    if (opts.rate_limit > 0 || opts.max_in_flight > 0) {
+        for (const auto& entry : entries) {
+            if (!server_limiters.contains(entry.server)) {
+                limiters.push_back(std::make_unique<RateLimiter>(opts.rate_limit, opts.rate_burst, opts.max_in_flight));
+                server_limiters.insert(entry.server, limiters.back().get());
+            }
+        }
+    }
+
+    //Servers and (name, type) are interned once, duplicates share their id
+    QList<TrackerTarget> targets;
+    targets.reserve(entries.size());
+    QHash<QString, quint32> server_ids;
+    QHash<QPair<QString, int>, quint32> name_ids;
+    for (const auto& entry : entries) {
+        TrackerTarget target;
+        Options& server_opts = target.options;
+        server_opts = opts;
+        server_opts.dns_name = entry.name;
+        server_opts.dns_server = entry.server;
+        server_opts.record_type = entry.type;
+        if (entry.interval_ms > 0) {
+            server_opts.sleep_intervall = static_cast<size_t>(entry.interval_ms);
+            server_opts.start_spread = opts.multi_requests ? server_opts.sleep_intervall : 0;
+        }
+        server_opts.server_id = server_ids.value(entry.server, static_cast<quint32>(server_ids.size()));
+        server_ids.insert(entry.server, server_opts.server_id);
+        const auto name_key = qMakePair(entry.name, static_cast<int>(entry.type));
+        server_opts.target_id = name_ids.value(name_key, static_cast<quint32>(name_ids.size()));
+        name_ids.insert(name_key, server_opts.target_id);
+        if (convergence) {
+            convergence->add_server(server_opts.target_id, server_opts.server_id, entry.server);
+        }
+
+        target.latency = display->latency()->histogram(server_opts.server_id, server_opts.target_id);
+        target.limiter = server_limiters.value(entry.server, nullptr);
+        target.answers = simulation ? simulation->answers() : nullptr;
+        if (metrics) {
+            target.metrics = metrics->add_target(server_opts.server_id, server_opts.target_id, entry.server, entry.name,
+                                                 entry.type);
+        }
+        targets.append(target);
+    }
+
+    auto pool = new TrackerPool(display, &app);
+    QObject::connect(pool, &TrackerPool::finished, &app, &QCoreApplication::quit);
+    if (!pool->start(targets, opts.threads)) {
+        pool->stop();
+        return 1;
+    }
+    //Once every target has converged the last tracker finishes and the program ends
+    if (convergence) {
+        QObject::connect(convergence, &Convergence::converged, pool, &TrackerPool::stop_target);
+    }
+    if (metrics) {
+        for (auto scheduler : pool->schedulers()) {
+            metrics->add_scheduler(scheduler);
+        }
+    }
+    if (opts.verbose) {
+        std::cerr << "Tracker-threads: " << pool->thread_count() << std::endl;
+    }
+
+    int result = 0;
+    if (simulation) {
+        simulation->run(pool, display, opts.verbose);
+    } else {
+        result = app.exec();
     }
 
-    return app.exec();
+    //Report of adaptive polling: queries sent compared with the fixed interval
+    if (opts.adaptive_polling) {
+        quint64 sent = 0;
+        quint64 fixed = 0;
+        pool->polling_report(sent, fixed);
+        const quint64 saved = fixed - sent;
+        std::cout << "Adaptive polling: " << sent << " queries sent, " << fixed
+                  << " with fixed interval, " << saved << " saved ("
+                  << (fixed > 0 ? saved * 100 / fixed : 0) << "%)" << std::endl;
+    }
+    //Report of the raw fast-path: replies which only differed in message-id and TTLs
+    if (opts.native_backend && opts.continue_measurment && !simulation) {
+        quint64 received = 0;
+        quint64 reused = 0;
+        pool->reply_report(received, reused);
+        std::cout << "Raw fast-path: " << reused << " of " << received
+                  << " replies unchanged, parsing and hashing skipped ("
+                  << (received > 0 ? reused * 100 / received : 0) << "%)" << std::endl;
+    }
+    pool->stop();
+    if (convergence) {
+        convergence->print_report(std::cout);
+    }
+    if (!opts.trace_filepath.isEmpty()) {
+        Tracing::dump(opts.trace_filepath);
+    }
+    return result;
 }
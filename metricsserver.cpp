@@ -0,0 +1,260 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the metrics-endpoint. Every connection serves one
+ * request and is closed afterwards (HTTP/1.1 with Connection: close).
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "metricsserver.h"
+#include "display.h"
+#include "scheduler.h"
+#include "dnstracker.h"
+#include "latencyhistogram.h"
+#include "recordtraits.h"
+
+#include <iostream>
+
+#include <QTcpSocket>
+
+namespace {
+
+/*Label-values have to escape backslash, double-quote and line-feed*/
+QByteArray escape_label(const QString& value) {
+    QByteArray escaped;
+    const QByteArray utf8 = value.toUtf8();
+    escaped.reserve(utf8.size());
+    for (char c : utf8) {
+        if (c == '\\' || c == '"') {
+            escaped.append('\\');
+            escaped.append(c);
+        } else if (c == '\n') {
+            escaped.append("\\n");
+        } else {
+            escaped.append(c);
+        }
+    }
+    return escaped;
+}
+
+const QByteArray& target_labels(const TargetMetrics& target) {
+    return target.labels;
+}
+
+void family(QByteArray& out, const char* name, const char* type, const char* help) {
+    out += QByteArray("# TYPE ") + name + " " + type + "\n";
+    out += QByteArray("# HELP ") + name + " " + help + "\n";
+}
+
+QByteArray seconds(qint64 value_us) {
+    return QByteArray::number(static_cast<double>(value_us) / 1e6, 'g', 9);
+}
+
+}
+
+MetricsServer::MetricsServer(Display* display, QObject* parent) :
+    QObject(parent), m_server(this), m_display(display) {
+    QObject::connect(&m_server, &QTcpServer::newConnection, this, &MetricsServer::accept_connection);
+}
+
+bool MetricsServer::listen(const QHostAddress& address, quint16 port) {
+    if (!m_server.listen(address, port)) {
+        std::cerr << "Metrics-endpoint could not be opened: " << m_server.errorString().toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*The type is part of the labels, a name can be tracked with several record-types at one server*/
+TargetMetrics* MetricsServer::add_target(quint32 server_id, quint32 target_id, const QString& server, const QString& name,
+                                         QDnsLookup::Type type) {
+    auto target = std::make_unique<TargetMetrics>();
+    target->server_id = server_id;
+    target->target_id = target_id;
+    target->server = server;
+    target->name = name;
+    QByteArray type_name;
+    dispatch_record_type(type, [&type_name](auto traits) {
+        type_name = decltype(traits)::NAME;
+    });
+    target->labels = "server=\"" + escape_label(server) + "\",name=\"" + escape_label(name) + "\",type=\"" + type_name + "\"";
+    m_targets.push_back(std::move(target));
+    return m_targets.back().get();
+}
+
+void MetricsServer::add_scheduler(Scheduler* scheduler) {
+    m_schedulers.push_back(scheduler);
+}
+
+void MetricsServer::accept_connection() {
+    while (m_server.hasPendingConnections()) {
+        QTcpSocket* socket = m_server.nextPendingConnection();
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        QObject::connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            MetricsServer::handle_request(socket);
+        });
+    }
+}
+
+void MetricsServer::handle_request(QTcpSocket* socket) {
+    //The request is complete with the empty line after the headers, a body is not expected
+    QByteArray request = socket->peek(MAX_REQUEST_SIZE + 1);
+    if (request.indexOf("\r\n\r\n") < 0 && request.indexOf("\n\n") < 0) {
+        if (request.size() > MAX_REQUEST_SIZE) {
+            MetricsServer::send_response(socket, "431 Request Header Fields Too Large", "text/plain", "");
+        }
+        return;
+    }
+    socket->readAll();
+
+    const QList<QByteArray> request_line = request.left(request.indexOf('\n')).trimmed().split(' ');
+    if (request_line.size() < 2 || request_line[0] != "GET") {
+        MetricsServer::send_response(socket, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+        return;
+    }
+    const QByteArray path = request_line[1].split('?').first();
+    if (path != "/metrics") {
+        MetricsServer::send_response(socket, "404 Not Found", "text/plain", "Metrics are served at /metrics\n");
+        return;
+    }
+    MetricsServer::send_response(socket, "200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8",
+                                 MetricsServer::render());
+}
+
+void MetricsServer::send_response(QTcpSocket* socket, const QByteArray& status, const QByteArray& content_type, const QByteArray& body) {
+    QByteArray response = "HTTP/1.1 " + status + "\r\n"
+                          + "Content-Type: " + content_type + "\r\n"
+                          + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                          + "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+QByteArray MetricsServer::render() const {
+    QByteArray out;
+    out.reserve(256 + static_cast<qsizetype>(m_targets.size()) * 1024);
+
+    //Snapshot of the counters, the trackers keep counting meanwhile
+    struct Snapshot {
+        quint64 sent;
+        quint64 responses;
+        quint64 errors;
+        quint64 changes;
+    };
+    std::vector<Snapshot> snapshot;
+    snapshot.reserve(m_targets.size());
+    for (const auto& target : m_targets) {
+        snapshot.push_back({target->queries_sent.load(std::memory_order_relaxed),
+                            target->responses.load(std::memory_order_relaxed),
+                            target->errors.load(std::memory_order_relaxed),
+                            target->changes.load(std::memory_order_relaxed)});
+    }
+
+    family(out, "dns_tracker_queries", "counter", "DNS-queries sent.");
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        out += "dns_tracker_queries_total{" + target_labels(*m_targets[i]) + "} " + QByteArray::number(snapshot[i].sent) + "\n";
+    }
+    family(out, "dns_tracker_responses", "counter", "DNS-responses received without error.");
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        out += "dns_tracker_responses_total{" + target_labels(*m_targets[i]) + "} " + QByteArray::number(snapshot[i].responses) + "\n";
+    }
+    family(out, "dns_tracker_errors", "counter", "DNS-lookups which ended with an error or timeout.");
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        out += "dns_tracker_errors_total{" + target_labels(*m_targets[i]) + "} " + QByteArray::number(snapshot[i].errors) + "\n";
+    }
+    family(out, "dns_tracker_timeouts", "counter", "DNS-lookups without an answer within the timeout.");
+    for (const auto& target : m_targets) {
+        out += "dns_tracker_timeouts_total{" + target_labels(*target) + "} "
+               + QByteArray::number(target->timeouts.load(std::memory_order_relaxed)) + "\n";
+    }
+    family(out, "dns_tracker_retries", "counter", "DNS-lookups repeated after a transient error.");
+    for (const auto& target : m_targets) {
+        out += "dns_tracker_retries_total{" + target_labels(*target) + "} "
+               + QByteArray::number(target->retries.load(std::memory_order_relaxed)) + "\n";
+    }
+    family(out, "dns_tracker_throttled", "counter", "DNS-lookups delayed by the rate-limit or in-flight cap of the server.");
+    for (const auto& target : m_targets) {
+        out += "dns_tracker_throttled_total{" + target_labels(*target) + "} "
+               + QByteArray::number(target->throttled.load(std::memory_order_relaxed)) + "\n";
+    }
+    family(out, "dns_tracker_changes", "counter", "Changes of the response-hash.");
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        out += "dns_tracker_changes_total{" + target_labels(*m_targets[i]) + "} " + QByteArray::number(snapshot[i].changes) + "\n";
+    }
+    family(out, "dns_tracker_queries_saved", "gauge", "Queries saved by adaptive polling compared with the fixed interval.");
+    for (const auto& target : m_targets) {
+        out += "dns_tracker_queries_saved{" + target_labels(*target) + "} "
+               + QByteArray::number(target->queries_saved.load(std::memory_order_relaxed)) + "\n";
+    }
+    family(out, "dns_tracker_in_flight", "gauge", "DNS-queries sent but not answered yet.");
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        const quint64 done = snapshot[i].responses + snapshot[i].errors;
+        const quint64 in_flight = snapshot[i].sent > done ? snapshot[i].sent - done : 0;
+        out += "dns_tracker_in_flight{" + target_labels(*m_targets[i]) + "} " + QByteArray::number(in_flight) + "\n";
+    }
+
+    //Cumulative, so it can be aggregated over servers and rated like a counter
+    family(out, "dns_tracker_rtt_seconds", "histogram", "Round-trip-time of the DNS-lookups.");
+    for (const auto& target : m_targets) {
+        const QByteArray labels = target_labels(*target);
+        quint64 count = 0;
+        for (int bucket = 0; bucket <= TargetMetrics::RTT_BOUNDS; ++bucket) {
+            count += target->rtt_buckets[bucket].load(std::memory_order_relaxed);
+            const QByteArray le = bucket < TargetMetrics::RTT_BOUNDS ? seconds(TargetMetrics::RTT_BOUNDS_US[bucket]) : QByteArray("+Inf");
+            out += "dns_tracker_rtt_seconds_bucket{" + labels + ",le=\"" + le + "\"} " + QByteArray::number(count) + "\n";
+        }
+        out += "dns_tracker_rtt_seconds_count{" + labels + "} " + QByteArray::number(count) + "\n";
+        out += "dns_tracker_rtt_seconds_sum{" + labels + "} "
+               + seconds(static_cast<qint64>(target->rtt_sum_us.load(std::memory_order_relaxed))) + "\n";
+    }
+
+    if (m_display) {
+        const qint64 now_ms = DnsTracker::current_time_ms();
+        //Percentiles of the HDR-histogram, over the last one to two windows with --rtt-window
+        family(out, "dns_tracker_rtt_window_seconds", "gauge", "Percentiles of the round-trip-time of the DNS-lookups.");
+        QByteArray max_lines;
+        for (const auto& target : m_targets) {
+            const LatencyHistogram* histogram = m_display->latency()->find(target->server_id, target->target_id);
+            if (!histogram) {
+                continue;
+            }
+            const LatencyHistogram::Summary rtt = histogram->summary(now_ms);
+            const QByteArray labels = target_labels(*target);
+            out += "dns_tracker_rtt_window_seconds{" + labels + ",percentile=\"50\"} " + seconds(rtt.p50_us) + "\n";
+            out += "dns_tracker_rtt_window_seconds{" + labels + ",percentile=\"99\"} " + seconds(rtt.p99_us) + "\n";
+            out += "dns_tracker_rtt_window_seconds{" + labels + ",percentile=\"99.9\"} " + seconds(rtt.p999_us) + "\n";
+            max_lines += "dns_tracker_rtt_max_seconds{" + labels + "} " + seconds(rtt.max_us) + "\n";
+        }
+        family(out, "dns_tracker_rtt_max_seconds", "gauge", "Largest round-trip-time of the DNS-lookups.");
+        out += max_lines;
+
+        family(out, "dns_tracker_export_queue_depth", "gauge", "Rows waiting for the export writer-thread.");
+        out += "dns_tracker_export_queue_depth{format=\"csv\"} " + QByteArray::number(static_cast<quint64>(m_display->export_queue_depth())) + "\n";
+        out += "dns_tracker_export_queue_depth{format=\"binary\"} " + QByteArray::number(static_cast<quint64>(m_display->history_queue_depth())) + "\n";
+    }
+
+    if (!m_schedulers.empty()) {
+        QByteArray max_lines;
+        family(out, "dns_tracker_scheduler_lag_seconds", "gauge", "Delay of the last scheduler-tick behind the clock.");
+        for (size_t i = 0; i < m_schedulers.size(); ++i) {
+            const QByteArray labels = "{worker=\"" + QByteArray::number(static_cast<quint64>(i)) + "\"} ";
+            out += "dns_tracker_scheduler_lag_seconds" + labels + seconds(m_schedulers[i]->last_lag_ms() * 1000) + "\n";
+            max_lines += "dns_tracker_scheduler_lag_max_seconds" + labels + seconds(m_schedulers[i]->max_lag_ms() * 1000) + "\n";
+        }
+        family(out, "dns_tracker_scheduler_lag_max_seconds", "gauge", "Largest delay of a scheduler-tick behind the clock.");
+        out += max_lines;
+    }
+
+    out += "# EOF\n";
+    return out;
+}
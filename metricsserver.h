@@ -0,0 +1,102 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Embedded HTTP-listener which serves the live metrics of the tracker
+ * in the OpenMetrics text-format (GET /metrics), so a long running probe
+ * can be scraped by Prometheus.
+ * The trackers only increment atomic counters, the text is built from
+ * a snapshot of these counters when a scrape arrives.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QTcpServer>
+#include <QHostAddress>
+#include <QString>
+#include <QDnsLookup>
+
+class Display;
+class Scheduler;
+class QTcpSocket;
+
+struct TargetMetrics {
+    quint32 server_id = 0;
+    quint32 target_id = 0;
+    QString server;
+    QString name;
+    //server, name and record-type, escaped once when the target is added
+    QByteArray labels;
+    std::atomic<quint64> queries_sent{0};
+    std::atomic<quint64> responses{0};
+    std::atomic<quint64> errors{0};
+    std::atomic<quint64> timeouts{0};
+    std::atomic<quint64> retries{0};
+    std::atomic<quint64> throttled{0};
+    std::atomic<quint64> changes{0};
+    std::atomic<quint64> queries_saved{0};
+
+    //Cumulative RTT-histogram, a coarse view of the HDR-buckets which never resets with --rtt-window
+    static constexpr int RTT_BOUNDS = 13;
+    static constexpr qint64 RTT_BOUNDS_US[RTT_BOUNDS] = {500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+                                                         250000, 500000, 1000000, 2500000, 5000000};
+    //The last bucket counts everything above the largest bound (+Inf)
+    std::atomic<quint64> rtt_buckets[RTT_BOUNDS + 1] = {};
+    std::atomic<quint64> rtt_sum_us{0};
+
+    void record_rtt(qint64 rtt_us) {
+        int bucket = 0;
+        while (bucket < RTT_BOUNDS && rtt_us > RTT_BOUNDS_US[bucket]) {
+            ++bucket;
+        }
+        rtt_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        rtt_sum_us.fetch_add(static_cast<quint64>(rtt_us), std::memory_order_relaxed);
+    }
+};
+
+class MetricsServer : public QObject {
+    Q_OBJECT
+
+public:
+    MetricsServer(Display* display, QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address, quint16 port);
+    TargetMetrics* add_target(quint32 server_id, quint32 target_id, const QString& server, const QString& name,
+                              QDnsLookup::Type type);
+    //One scheduler per worker-thread, the lag is labeled with its index
+    void add_scheduler(Scheduler* scheduler);
+
+    QByteArray render() const;
+
+private slots:
+    void accept_connection();
+
+private:
+    //Requests larger than this are answered with an error
+    static constexpr int MAX_REQUEST_SIZE = 8192;
+
+    QTcpServer m_server;
+    Display* m_display;
+    std::vector<Scheduler*> m_schedulers;
+    std::vector<std::unique_ptr<TargetMetrics>> m_targets;
+
+    void handle_request(QTcpSocket* socket);
+    void send_response(QTcpSocket* socket, const QByteArray& status, const QByteArray& content_type, const QByteArray& body);
+};
+
+#endif // METRICSSERVER_H
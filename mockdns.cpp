@@ -0,0 +1,168 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The mockdns.cpp starts the mock-responder as standalone DNS-server, so
+ * dns_tracker can be run against it by hand:
+ *   dns_mock --listen 127.0.0.1 127.0.0.2 --port 5353 --change-at 30
+ *   dns_tracker -t A -s 127.0.0.1 127.0.0.2 -n www.example.com -c 5
+ *               --backend=native --dns-port=5353
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include <iostream>
+#include <getopt.h>
+
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTimer>
+
+#include "mockresponder.h"
+
+void print_help() {
+    std::cout << "Usage: dns_mock [OPTION]" << std::endl;
+    std::cout << "Local DNS-server (UDP and TCP) with scripted or generated A- and SRV-answers." << std::endl;
+    std::cout << "\t--listen=IP ... (one server per address, default 127.0.0.1)" << std::endl;
+    std::cout << "\t--port=PORT (default 5353)" << std::endl;
+    std::cout << "\t--script=FILEPATH (answers per line: NAME A|SRV AT-SEC TTL VALUE..., unknown names get NXDOMAIN)" << std::endl;
+    std::cout << "\t--ttl=SEC (TTL of generated answers, default 60)" << std::endl;
+    std::cout << "\t--records=N (records per generated answer, default 1)" << std::endl;
+    std::cout << "\t--change-at=SEC (generated answers change after SEC seconds, default never)" << std::endl;
+    std::cout << "\t--change-every=SEC (and then again every SEC seconds)" << std::endl;
+    std::cout << "\t--stagger=MS (server i sees every change i*MS milliseconds later)" << std::endl;
+    std::cout << "\t--latency=MS (delay of every answer)" << std::endl;
+    std::cout << "\t--jitter=MS (random extra delay up to MS)" << std::endl;
+    std::cout << "\t--loss=P (probability 0..1 that a UDP-query is not answered)" << std::endl;
+    std::cout << "\t--seed=N (seed of jitter and loss, default 1)" << std::endl;
+    std::cout << "\t--stats=SEC (print queries, answers and drops every SEC seconds to stderr)" << std::endl;
+    std::cout << "\t[-h show help]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    MockResponder::Settings settings;
+    QList<QHostAddress> addresses;
+    QString script;
+    int stats_sec = 0;
+
+    static struct option long_opts[] = {
+        {"listen", required_argument, nullptr, 'l'},
+        {"port", required_argument, nullptr, 'p'},
+        {"script", required_argument, nullptr, 's'},
+        {"ttl", required_argument, nullptr, 't'},
+        {"records", required_argument, nullptr, 'n'},
+        {"change-at", required_argument, nullptr, 'a'},
+        {"change-every", required_argument, nullptr, 'e'},
+        {"stagger", required_argument, nullptr, 'g'},
+        {"latency", required_argument, nullptr, 'd'},
+        {"jitter", required_argument, nullptr, 'j'},
+        {"loss", required_argument, nullptr, 'x'},
+        {"seed", required_argument, nullptr, 'r'},
+        {"stats", required_argument, nullptr, 'S'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "l:p:s:h", long_opts, nullptr)) != -1) {
+        try {
+            switch (opt) {
+            case 'l':
+                addresses.append(QHostAddress(QString::fromUtf8(optarg)));
+                while (optind < argc && argv[optind][0] != '-') {
+                    addresses.append(QHostAddress(QString::fromUtf8(argv[optind])));
+                    ++optind;
+                }
+                break;
+            case 'p': {
+                const int port = std::stoi(optarg);
+                if (port <= 0 || port > 65535) throw std::invalid_argument("out of range");
+                settings.port = static_cast<quint16>(port);
+                break;
+            }
+            case 's':
+                script = QString::fromUtf8(optarg);
+                break;
+            case 't':
+                settings.answers.ttl = static_cast<quint32>(std::stoul(optarg));
+                break;
+            case 'n':
+                settings.answers.records = std::stoi(optarg);
+                if (settings.answers.records <= 0) throw std::invalid_argument("non-positive value");
+                break;
+            case 'a':
+                settings.answers.change_at_ms = static_cast<qint64>(std::stod(optarg) * 1000);
+                break;
+            case 'e':
+                settings.answers.change_every_ms = static_cast<qint64>(std::stod(optarg) * 1000);
+                break;
+            case 'g':
+                settings.answers.stagger_ms = std::stoll(optarg);
+                break;
+            case 'd':
+                settings.latency_ms = std::stoi(optarg);
+                break;
+            case 'j':
+                settings.jitter_ms = std::stoi(optarg);
+                break;
+            case 'x':
+                settings.loss = std::stod(optarg);
+                if (settings.loss < 0 || settings.loss > 1) throw std::invalid_argument("out of range");
+                break;
+            case 'r':
+                settings.seed = static_cast<quint32>(std::stoul(optarg));
+                break;
+            case 'S':
+                stats_sec = std::stoi(optarg);
+                break;
+            case 'h':
+                print_help();
+                return 0;
+            default:
+                print_help();
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Unsupported value: " << optarg << std::endl;
+            return 1;
+        }
+    }
+
+    if (addresses.isEmpty()) {
+        addresses.append(QHostAddress(QHostAddress::LocalHost));
+    }
+    for (const auto& address : addresses) {
+        if (address.isNull()) {
+            std::cerr << "Invalid listen-address" << std::endl;
+            return 1;
+        }
+    }
+
+    QCoreApplication app(argc, argv);
+    MockResponder responder(settings);
+    if (!script.isEmpty() && !responder.load_script(script)) {
+        return 1;
+    }
+    if (!responder.listen(addresses)) {
+        return 1;
+    }
+    std::cerr << "Listening on " << addresses.size() << " address(es), port " << settings.port << std::endl;
+
+    QTimer stats_timer;
+    if (stats_sec > 0) {
+        QObject::connect(&stats_timer, &QTimer::timeout, &app, [&responder]() {
+            std::cerr << "queries: " << responder.queries() << " answers: " << responder.answers()
+                      << " dropped: " << responder.dropped() << std::endl;
+        });
+        stats_timer.start(stats_sec * 1000);
+    }
+    return app.exec();
+}
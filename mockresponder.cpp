@@ -0,0 +1,274 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the mock-responder.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "mockresponder.h"
+#include "dnswire.h"
+#include "recordtraits.h"
+
+#include <iostream>
+#include <memory>
+
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtEndian>
+
+namespace {
+
+constexpr quint8 FLAG_QR = 0x80;
+constexpr quint8 FLAG_AA = 0x04;
+constexpr quint8 FLAG_TC = 0x02;
+constexpr quint8 FLAG_RD = 0x01;
+constexpr quint8 FLAG_RA = 0x80;
+constexpr quint8 RCODE_NXDOMAIN = 3;
+constexpr quint16 CLASS_IN = 1;
+//Classic limit of a UDP-answer without EDNS0
+constexpr qsizetype UDP_SIZE = 512;
+//Owner of every answer is the name of the question, right after the header
+constexpr quint16 QUESTION_POINTER = 0xC000 | DnsWire::HEADER_SIZE;
+
+inline void append_u16(QByteArray& out, quint16 value) {
+    out.append(static_cast<char>(value >> 8));
+    out.append(static_cast<char>(value & 0xFF));
+}
+
+inline void append_u32(QByteArray& out, quint32 value) {
+    append_u16(out, static_cast<quint16>(value >> 16));
+    append_u16(out, static_cast<quint16>(value & 0xFFFF));
+}
+
+inline void put_u16(QByteArray& out, qsizetype pos, quint16 value) {
+    out.data()[pos] = static_cast<char>(value >> 8);
+    out.data()[pos + 1] = static_cast<char>(value & 0xFF);
+}
+
+void append_record(QByteArray& out, const DnsARecord& rec, quint32 ttl) {
+    append_u16(out, QUESTION_POINTER);
+    append_u16(out, QDnsLookup::A);
+    append_u16(out, CLASS_IN);
+    append_u32(out, ttl);
+    append_u16(out, 4);
+    append_u32(out, rec.value.toIPv4Address());
+}
+
+void append_record(QByteArray& out, const DnsSrvRecord& rec, quint32 ttl) {
+    append_u16(out, QUESTION_POINTER);
+    append_u16(out, QDnsLookup::SRV);
+    append_u16(out, CLASS_IN);
+    append_u32(out, ttl);
+    const qsizetype length_pos = out.size();
+    append_u16(out, 0);
+    append_u16(out, rec.priority);
+    append_u16(out, rec.weight);
+    append_u16(out, rec.port);
+    DnsWire::append_name(out, rec.target);
+    put_u16(out, length_pos, static_cast<quint16>(out.size() - length_pos - 2));
+}
+
+//The script only knows A and SRV
+template <typename Record>
+void append_record(QByteArray&, const Record&, quint32) {}
+
+}
+
+MockResponder::MockResponder(const Settings& settings, QObject* parent)
+    : QObject(parent), m_settings(settings), m_script(settings.answers), m_random(settings.seed) {}
+
+qsizetype MockResponder::a_answer_size(const QString& name, int records) {
+    QByteArray question;
+    DnsWire::append_name(question, name);
+    //Header, question with type and class, every record is pointer, type, class, TTL, length and address
+    return DnsWire::HEADER_SIZE + question.size() + 4 + static_cast<qsizetype>(records) * 16;
+}
+
+bool MockResponder::load_script(const QString& filepath) {
+    return m_script.load(filepath);
+}
+
+bool MockResponder::listen(const QList<QHostAddress>& addresses) {
+    for (int i = 0; i < addresses.size(); ++i) {
+        const QHostAddress& address = addresses.at(i);
+        const std::string endpoint = address.toString().toStdString() + ":" + std::to_string(m_settings.port);
+
+        auto udp = new QUdpSocket(this);
+        if (!udp->bind(address, m_settings.port)) {
+            std::cerr << "UDP-port could not be bound: " << endpoint << " - " << udp->errorString().toStdString() << std::endl;
+            return false;
+        }
+        connect(udp, &QUdpSocket::readyRead, this, [this, udp, i]() {
+            MockResponder::read_udp(udp, i);
+        });
+        m_udp.append(udp);
+
+        auto tcp = new QTcpServer(this);
+        if (!tcp->listen(address, m_settings.port)) {
+            std::cerr << "TCP-port could not be bound: " << endpoint << " - " << tcp->errorString().toStdString() << std::endl;
+            return false;
+        }
+        connect(tcp, &QTcpServer::newConnection, this, [this, tcp, i]() {
+            MockResponder::accept_tcp(tcp, i);
+        });
+        m_tcp.append(tcp);
+    }
+    m_clock.start();
+    return true;
+}
+
+void MockResponder::read_udp(QUdpSocket* socket, int server) {
+    char buffer[DnsWire::EDNS_UDP_SIZE];
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    while (socket->hasPendingDatagrams()) {
+        QHostAddress sender;
+        quint16 sender_port = 0;
+        const qint64 size = socket->readDatagram(buffer, sizeof(buffer), &sender, &sender_port);
+        if (size <= 0) {
+            continue;
+        }
+        m_queries.fetch_add(1, std::memory_order_relaxed);
+        if (m_settings.loss > 0 && chance(m_random) < m_settings.loss) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        const QByteArray reply = MockResponder::answer(buffer, size, server, false);
+        if (reply.isEmpty()) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        m_answers.fetch_add(1, std::memory_order_relaxed);
+
+        const int delay = MockResponder::delay_ms();
+        if (delay <= 0) {
+            socket->writeDatagram(reply, sender, sender_port);
+        } else {
+            QTimer::singleShot(delay, socket, [socket, reply, sender, sender_port]() {
+                socket->writeDatagram(reply, sender, sender_port);
+            });
+        }
+    }
+}
+
+/*Messages over TCP are prefixed with their length, a connection may carry several*/
+void MockResponder::accept_tcp(QTcpServer* server_socket, int server) {
+    while (server_socket->hasPendingConnections()) {
+        QTcpSocket* socket = server_socket->nextPendingConnection();
+        auto pending = std::make_shared<QByteArray>();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket, pending, server]() {
+            pending->append(socket->readAll());
+            while (pending->size() >= 2) {
+                const qsizetype length = qFromBigEndian<quint16>(pending->constData());
+                if (pending->size() < 2 + length) {
+                    break;
+                }
+                m_queries.fetch_add(1, std::memory_order_relaxed);
+                const QByteArray reply = MockResponder::answer(pending->constData() + 2, length, server, true);
+                pending->remove(0, 2 + length);
+                if (reply.isEmpty()) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                m_answers.fetch_add(1, std::memory_order_relaxed);
+
+                QByteArray framed;
+                append_u16(framed, static_cast<quint16>(reply.size()));
+                framed.append(reply);
+                const int delay = MockResponder::delay_ms();
+                if (delay <= 0) {
+                    socket->write(framed);
+                } else {
+                    QTimer::singleShot(delay, socket, [socket, framed]() {
+                        socket->write(framed);
+                    });
+                }
+            }
+        });
+    }
+}
+
+/*Empty for a message which is no single question, it is not answered at all*/
+QByteArray MockResponder::answer(const char* raw, qsizetype size, int server, bool tcp) {
+    const uchar* data = reinterpret_cast<const uchar*>(raw);
+    if (size < DnsWire::HEADER_SIZE || (data[2] & FLAG_QR) || qFromBigEndian<quint16>(data + 4) != 1) {
+        return QByteArray();
+    }
+
+    QString name;
+    qsizetype pos = DnsWire::HEADER_SIZE;
+    while (true) {
+        if (pos >= size) {
+            return QByteArray();
+        }
+        const quint8 length = data[pos];
+        if (length == 0) {
+            ++pos;
+            break;
+        }
+        if (length > 63 || pos + 1 + length > size) {
+            return QByteArray();
+        }
+        if (!name.isEmpty()) {
+            name += '.';
+        }
+        name += QString::fromLatin1(raw + pos + 1, length);
+        pos += 1 + length;
+    }
+    if (pos + 4 > size) {
+        return QByteArray();
+    }
+    const quint16 type = qFromBigEndian<quint16>(data + pos);
+    const qsizetype question_end = pos + 4;
+    const bool edns = qFromBigEndian<quint16>(data + 10) > 0;
+
+    quint32 ttl = 0;
+    DnsRecordSet records;
+    bool exists = false;
+    m_script.find(AnswerScript::normalize(name), type, m_clock.elapsed(), server, ttl, records, exists);
+
+    QByteArray reply;
+    reply.reserve(UDP_SIZE);
+    reply.append(raw, 2);
+    reply.append(static_cast<char>(FLAG_QR | FLAG_AA | (data[2] & FLAG_RD)));
+    reply.append(static_cast<char>(FLAG_RA | (exists ? 0 : RCODE_NXDOMAIN)));
+    append_u16(reply, 1);
+    append_u16(reply, 0);
+    append_u16(reply, 0);
+    append_u16(reply, 0);
+    reply.append(raw + DnsWire::HEADER_SIZE, question_end - DnsWire::HEADER_SIZE);
+
+    std::visit([&reply, ttl](const auto& list) {
+        for (const auto& rec : list) {
+            append_record(reply, rec, ttl);
+        }
+    }, records);
+    put_u16(reply, 6, static_cast<quint16>(record_count(records)));
+
+    /*Too large for UDP: only the question with TC. The native backend has no TCP-fallback
+      and reports it as error, dns_tracker_load refuses such answers up front*/
+    const qsizetype limit = tcp ? 65535 : (edns ? DnsWire::EDNS_UDP_SIZE : UDP_SIZE);
+    if (reply.size() > limit) {
+        reply.truncate(question_end);
+        reply.data()[2] = static_cast<char>(reply.at(2) | FLAG_TC);
+        put_u16(reply, 6, 0);
+    }
+    return reply;
+}
+
+int MockResponder::delay_ms() {
+    if (m_settings.jitter_ms <= 0) {
+        return m_settings.latency_ms;
+    }
+    return m_settings.latency_ms + std::uniform_int_distribution<int>(0, m_settings.jitter_ms)(m_random);
+}
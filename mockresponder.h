@@ -0,0 +1,84 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The mock-responder is a small local DNS-server (UDP and TCP) to test
+ * the tracker without production resolvers. Every listen-address acts as
+ * one server, so N servers are 127.0.0.1 ... 127.0.0.N on one port.
+ * The answers come from the answer-script, scripted or generated, the
+ * time of the script starts with listen.
+ * Latency, jitter and loss of UDP-queries are simulated per query.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef MOCKRESPONDER_H
+#define MOCKRESPONDER_H
+
+#include <atomic>
+#include <random>
+#include <vector>
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QList>
+#include <QTcpServer>
+#include <QUdpSocket>
+
+#include "answerscript.h"
+
+class MockResponder : public QObject {
+    Q_OBJECT
+
+public:
+    struct Settings {
+        quint16 port = 5353;
+        AnswerScript::Settings answers;
+        int latency_ms = 0;
+        int jitter_ms = 0;
+        //Probability that a UDP-query is not answered
+        double loss = 0;
+        quint32 seed = 1;
+    };
+
+    MockResponder(const Settings& settings, QObject* parent = nullptr);
+
+    bool load_script(const QString& filepath);
+    //Starts the clock of the scheduled changes
+    bool listen(const QList<QHostAddress>& addresses);
+
+    quint64 queries() const { return m_queries.load(std::memory_order_relaxed); }
+    quint64 answers() const { return m_answers.load(std::memory_order_relaxed); }
+    quint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /*Size of the generated A-answer with records records for name. Larger than the
+      EDNS-size the UDP-reply is truncated, which the native backend reports as error*/
+    static qsizetype a_answer_size(const QString& name, int records);
+
+private:
+    Settings m_settings;
+    QList<QUdpSocket*> m_udp;
+    QList<QTcpServer*> m_tcp;
+    AnswerScript m_script;
+    QElapsedTimer m_clock;
+    std::mt19937 m_random;
+
+    std::atomic<quint64> m_queries{0};
+    std::atomic<quint64> m_answers{0};
+    std::atomic<quint64> m_dropped{0};
+
+    void read_udp(QUdpSocket* socket, int server);
+    void accept_tcp(QTcpServer* server_socket, int server);
+    QByteArray answer(const char* data, qsizetype size, int server, bool tcp);
+    int delay_ms();
+};
+
+#endif // MOCKRESPONDER_H
@@ -0,0 +1,100 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Lock-free queue with many producers and one consumer (Vyukov-style
+ * linked list). The worker-threads of the tracker-pool push their
+ * update-events, the main-thread drains them into the display.
+ * A push is one exchange on the head, the consumer never blocks a
+ * producer. While a producer is between exchange and link the consumer
+ * sees the queue as empty and picks the event up with the next drain.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+template <typename T>
+class MpscQueue {
+
+public:
+    MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    //Any thread
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    //Only the consumer-thread
+    bool pop(T& value) {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (next == nullptr) {
+                return false;
+            }
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            m_tail = next;
+            value = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            //A producer has exchanged the head but not linked its node yet
+            return false;
+        }
+        //Last node: the stub is put behind it, so it can be handed out
+        m_stub.next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = m_head.exchange(&m_stub, std::memory_order_acq_rel);
+        prev->next.store(&m_stub, std::memory_order_release);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            m_tail = next;
+            value = std::move(tail->value);
+            delete tail;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T&& v) : value(std::move(v)) {}
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    //Producers exchange the head, the consumer owns the tail
+    alignas(64) std::atomic<Node*> m_head;
+    alignas(64) Node* m_tail;
+    Node m_stub;
+};
+
+#endif // MPSCQUEUE_H
@@ -0,0 +1,190 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Flat index of the occurance-history of the display. Servers and
+ * targets are known by small integer ids, every occurance is found by
+ * (server id, target id, 64-bit hash) in one open-addressing table with
+ * linear probing. The entries live in one vector in the order they were
+ * first seen, targets are iterated sorted by server and name, so the
+ * render-order is stable.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef OCCURRENCETABLE_H
+#define OCCURRENCETABLE_H
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+template <typename Entry>
+class OccurrenceTable {
+
+public:
+    static constexpr quint32 INVALID_INDEX = 0xFFFFFFFF;
+
+    struct Target {
+        quint32 server_id;
+        quint32 target_id;
+        QString server;
+        QString name;
+        QVector<quint32> entries;
+    };
+
+    //Returns the entry of the hash, a new entry (inserted = true) only carries its hash
+    Entry& touch(quint32 server_id, quint32 target_id, const QByteArray& hash,
+                 const QString& server, const QString& name, bool& inserted);
+
+    const QVector<quint32>& target_order() const;
+    const Target& target(quint32 index) const { return m_targets[index]; }
+    const Entry& entry(quint32 index) const { return m_entries[index]; }
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Key {
+        quint32 server_id;
+        quint32 target_id;
+        quint64 hash;
+    };
+
+    QVector<Key> m_keys;
+    QVector<Entry> m_entries;
+    QVector<quint32> m_slots;
+    quint32 m_mask = 0;
+
+    QVector<Target> m_targets;
+    //Sorted when read, new targets wait in pending until then
+    mutable QVector<quint32> m_target_order;
+    mutable QVector<quint32> m_pending_targets;
+    //Target-index by [server id][target id]
+    QVector<QVector<quint32>> m_target_index;
+
+    static quint64 hash64(const QByteArray& hash);
+    static quint64 mix(const Key& key);
+    quint32 target_of(quint32 server_id, quint32 target_id, const QString& server, const QString& name);
+    bool target_less(quint32 a, quint32 b) const;
+    void grow();
+};
+
+template <typename Entry>
+quint64 OccurrenceTable<Entry>::hash64(const QByteArray& hash) {
+    quint64 value = 0;
+    std::memcpy(&value, hash.constData(), qMin<size_t>(sizeof(value), static_cast<size_t>(hash.size())));
+    return value;
+}
+
+/*Finalizer of murmur3, the ids are small and have to be spread over the table*/
+template <typename Entry>
+quint64 OccurrenceTable<Entry>::mix(const Key& key) {
+    quint64 k = key.hash ^ ((quint64(key.server_id) << 32) | key.target_id);
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+template <typename Entry>
+Entry& OccurrenceTable<Entry>::touch(quint32 server_id, quint32 target_id, const QByteArray& hash,
+                                     const QString& server, const QString& name, bool& inserted) {
+    if ((m_entries.size() + 1) * 10 > m_slots.size() * 7) {
+        OccurrenceTable::grow();
+    }
+
+    const Key key{server_id, target_id, hash64(hash)};
+    quint32 slot = static_cast<quint32>(mix(key)) & m_mask;
+    while (m_slots[slot] != INVALID_INDEX) {
+        const quint32 index = m_slots[slot];
+        const Key& other = m_keys[index];
+        if (other.hash == key.hash && other.server_id == server_id && other.target_id == target_id
+            && m_entries[index].hash == hash) {
+            inserted = false;
+            return m_entries[index];
+        }
+        slot = (slot + 1) & m_mask;
+    }
+
+    const quint32 index = static_cast<quint32>(m_entries.size());
+    m_slots[slot] = index;
+    m_keys.append(key);
+    m_entries.append(Entry());
+    m_entries[index].hash = hash;
+    m_targets[OccurrenceTable::target_of(server_id, target_id, server, name)].entries.append(index);
+    inserted = true;
+    return m_entries[index];
+}
+
+template <typename Entry>
+quint32 OccurrenceTable<Entry>::target_of(quint32 server_id, quint32 target_id, const QString& server, const QString& name) {
+    if (m_target_index.size() <= static_cast<qsizetype>(server_id)) {
+        m_target_index.resize(static_cast<qsizetype>(server_id) + 1);
+    }
+    QVector<quint32>& by_target = m_target_index[server_id];
+    while (by_target.size() <= static_cast<qsizetype>(target_id)) {
+        by_target.append(INVALID_INDEX);
+    }
+    if (by_target[target_id] != INVALID_INDEX) {
+        return by_target[target_id];
+    }
+
+    //A target-file brings many targets at once, they are sorted in with the next read of the order
+    const quint32 index = static_cast<quint32>(m_targets.size());
+    m_targets.append(Target{server_id, target_id, server, name, {}});
+    by_target[target_id] = index;
+    m_pending_targets.append(index);
+    return index;
+}
+
+template <typename Entry>
+bool OccurrenceTable<Entry>::target_less(quint32 a, quint32 b) const {
+    const Target& left = m_targets[a];
+    const Target& right = m_targets[b];
+    if (left.server != right.server) {
+        return left.server < right.server;
+    }
+    return left.name < right.name;
+}
+
+/*Render-order by server and name, equal targets in the order they were first seen*/
+template <typename Entry>
+const QVector<quint32>& OccurrenceTable<Entry>::target_order() const {
+    if (!m_pending_targets.isEmpty()) {
+        const auto less = [this](quint32 a, quint32 b) { return OccurrenceTable::target_less(a, b); };
+        std::stable_sort(m_pending_targets.begin(), m_pending_targets.end(), less);
+        const qsizetype sorted = m_target_order.size();
+        m_target_order.append(m_pending_targets);
+        m_pending_targets.clear();
+        std::inplace_merge(m_target_order.begin(), m_target_order.begin() + sorted, m_target_order.end(), less);
+    }
+    return m_target_order;
+}
+
+template <typename Entry>
+void OccurrenceTable<Entry>::grow() {
+    const quint32 capacity = m_slots.isEmpty() ? 64 : static_cast<quint32>(m_slots.size()) * 2;
+    m_slots.fill(INVALID_INDEX, capacity);
+    m_mask = capacity - 1;
+    for (quint32 index = 0; index < static_cast<quint32>(m_keys.size()); ++index) {
+        quint32 slot = static_cast<quint32>(mix(m_keys[index])) & m_mask;
+        while (m_slots[slot] != INVALID_INDEX) {
+            slot = (slot + 1) & m_mask;
+        }
+        m_slots[slot] = index;
+    }
+}
+
+#endif // OCCURRENCETABLE_H
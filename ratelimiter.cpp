@@ -0,0 +1,60 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the token-bucket and in-flight cap per DNS-server.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "ratelimiter.h"
+#include "clock.h"
+
+RateLimiter::RateLimiter(double rate, int burst, int max_in_flight) : m_max_in_flight(qMax(0, max_in_flight)) {
+    if (rate > 0) {
+        m_interval_us = qMax<qint64>(1, static_cast<qint64>(1e6 / rate));
+        m_tolerance_us = static_cast<qint64>(qMax(1, burst) - 1) * m_interval_us;
+    }
+    m_origin_us = Clock::instance()->now_us();
+}
+
+qint64 RateLimiter::acquire() {
+    if (m_max_in_flight > 0 && m_in_flight.fetch_add(1, std::memory_order_acq_rel) >= m_max_in_flight) {
+        m_in_flight.fetch_sub(1, std::memory_order_acq_rel);
+        m_throttled.fetch_add(1, std::memory_order_relaxed);
+        return IN_FLIGHT_RETRY_MS;
+    }
+    if (m_interval_us == 0) {
+        return 0;
+    }
+
+    //A query is allowed while the next arrival lies at most the burst ahead of now
+    const qint64 now_us = Clock::instance()->now_us() - m_origin_us;
+    qint64 next_us = m_next_us.load(std::memory_order_relaxed);
+    while (true) {
+        const qint64 arrival = qMax(next_us, now_us);
+        if (arrival - now_us > m_tolerance_us) {
+            if (m_max_in_flight > 0) {
+                m_in_flight.fetch_sub(1, std::memory_order_acq_rel);
+            }
+            m_throttled.fetch_add(1, std::memory_order_relaxed);
+            return (arrival - m_tolerance_us - now_us + 999) / 1000;
+        }
+        if (m_next_us.compare_exchange_weak(next_us, arrival + m_interval_us, std::memory_order_relaxed)) {
+            return 0;
+        }
+    }
+}
+
+void RateLimiter::release() {
+    if (m_max_in_flight > 0) {
+        m_in_flight.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
@@ -0,0 +1,58 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The rate-limiter protects one DNS-server from the tracker: a token-bucket
+ * limits the queries per second (with a burst) and a counter caps the
+ * queries in flight. It is shared by all trackers of the server, also
+ * over the worker-threads, so both are lock-free atomics.
+ * The bucket is kept as the theoretical arrival time of the next query
+ * (GCRA), one compare-exchange per query.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <atomic>
+
+#include <QtGlobal>
+
+class RateLimiter {
+
+public:
+    //rate in queries per second (0 = unlimited), max_in_flight 0 = no cap
+    RateLimiter(double rate, int burst, int max_in_flight);
+
+    //0 if the query may be sent now, otherwise the wait in ms before the next try
+    qint64 acquire();
+    //Has to be called once for every successful acquire when the query is answered or failed
+    void release();
+
+    quint64 throttled() const { return m_throttled.load(std::memory_order_relaxed); }
+    int in_flight() const { return m_in_flight.load(std::memory_order_relaxed); }
+
+private:
+    //Without a completion-signal a capped query is simply tried again after this time
+    static constexpr qint64 IN_FLIGHT_RETRY_MS = 50;
+
+    //Clock-time of the construction, the arrivals count from here
+    qint64 m_origin_us = 0;
+    qint64 m_interval_us = 0;
+    qint64 m_tolerance_us = 0;
+    int m_max_in_flight = 0;
+
+    std::atomic<qint64> m_next_us{0};
+    std::atomic<int> m_in_flight{0};
+    std::atomic<quint64> m_throttled{0};
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,209 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Compile-time description of the supported record-types. Every type
+ * names its record-struct and how QDnsLookup delivers it, the rest of the
+ * pipeline (wire-decoding, hashing, store, rendering, export) is written
+ * once as templates or overloads over the record-struct.
+ * The type given on the command-line is resolved once at setup with
+ * dispatch_record_type(), the hot path never compares type-names.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef RECORDTRAITS_H
+#define RECORDTRAITS_H
+
+#include <QDnsLookup>
+#include <QString>
+
+#include "dnsrecord.h"
+
+template <QDnsLookup::Type T>
+struct RecordTraits;
+
+template <>
+struct RecordTraits<QDnsLookup::A> {
+    using Record = DnsARecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::A;
+    static constexpr const char* NAME = "A";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        QList<Record> records;
+        const auto answers = lookup.hostAddressRecords();
+        for (const auto& rec : answers) {
+            records.append({rec.name(), rec.value(), rec.timeToLive()});
+        }
+        return records;
+    }
+};
+
+template <>
+struct RecordTraits<QDnsLookup::AAAA> {
+    using Record = DnsARecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::AAAA;
+    static constexpr const char* NAME = "AAAA";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        return RecordTraits<QDnsLookup::A>::read(lookup);
+    }
+};
+
+template <>
+struct RecordTraits<QDnsLookup::SRV> {
+    using Record = DnsSrvRecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::SRV;
+    static constexpr const char* NAME = "SRV";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        QList<Record> records;
+        const auto answers = lookup.serviceRecords();
+        for (const auto& rec : answers) {
+            records.append({rec.name(), rec.target(), rec.priority(), rec.weight(), rec.port(), rec.timeToLive()});
+        }
+        return records;
+    }
+};
+
+template <>
+struct RecordTraits<QDnsLookup::MX> {
+    using Record = DnsMxRecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::MX;
+    static constexpr const char* NAME = "MX";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        QList<Record> records;
+        const auto answers = lookup.mailExchangeRecords();
+        for (const auto& rec : answers) {
+            records.append({rec.name(), rec.exchange(), rec.preference(), rec.timeToLive()});
+        }
+        return records;
+    }
+};
+
+template <>
+struct RecordTraits<QDnsLookup::TXT> {
+    using Record = DnsTxtRecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::TXT;
+    static constexpr const char* NAME = "TXT";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        QList<Record> records;
+        const auto answers = lookup.textRecords();
+        for (const auto& rec : answers) {
+            records.append({rec.name(), rec.values(), rec.timeToLive()});
+        }
+        return records;
+    }
+};
+
+template <>
+struct RecordTraits<QDnsLookup::CNAME> {
+    using Record = DnsNameRecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::CNAME;
+    static constexpr const char* NAME = "CNAME";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        QList<Record> records;
+        const auto answers = lookup.canonicalNameRecords();
+        for (const auto& rec : answers) {
+            records.append({rec.name(), rec.value(), rec.timeToLive()});
+        }
+        return records;
+    }
+};
+
+template <>
+struct RecordTraits<QDnsLookup::NS> {
+    using Record = DnsNameRecord;
+    static constexpr QDnsLookup::Type TYPE = QDnsLookup::NS;
+    static constexpr const char* NAME = "NS";
+
+    static QList<Record> read(const QDnsLookup& lookup) {
+        QList<Record> records;
+        const auto answers = lookup.nameServerRecords();
+        for (const auto& rec : answers) {
+            records.append({rec.name(), rec.value(), rec.timeToLive()});
+        }
+        return records;
+    }
+};
+
+/*Calls fn with the traits of the type, returns false for an unsupported type*/
+template <typename Fn>
+bool dispatch_record_type(QDnsLookup::Type type, Fn&& fn) {
+    switch (type) {
+    case QDnsLookup::A:
+        fn(RecordTraits<QDnsLookup::A>());
+        return true;
+    case QDnsLookup::AAAA:
+        fn(RecordTraits<QDnsLookup::AAAA>());
+        return true;
+    case QDnsLookup::SRV:
+        fn(RecordTraits<QDnsLookup::SRV>());
+        return true;
+    case QDnsLookup::MX:
+        fn(RecordTraits<QDnsLookup::MX>());
+        return true;
+    case QDnsLookup::TXT:
+        fn(RecordTraits<QDnsLookup::TXT>());
+        return true;
+    case QDnsLookup::CNAME:
+        fn(RecordTraits<QDnsLookup::CNAME>());
+        return true;
+    case QDnsLookup::NS:
+        fn(RecordTraits<QDnsLookup::NS>());
+        return true;
+    default:
+        return false;
+    }
+}
+
+inline bool parse_record_type(const QString& name, QDnsLookup::Type& type) {
+    const QDnsLookup::Type types[] = {QDnsLookup::A, QDnsLookup::AAAA, QDnsLookup::SRV, QDnsLookup::MX,
+                                      QDnsLookup::TXT, QDnsLookup::CNAME, QDnsLookup::NS};
+    for (const QDnsLookup::Type candidate : types) {
+        bool match = false;
+        dispatch_record_type(candidate, [&](auto traits) {
+            match = name.compare(QString(decltype(traits)::NAME), Qt::CaseInsensitive) == 0;
+        });
+        if (match) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*The records of a set, empty if the set holds another record-struct*/
+template <typename Record>
+const QList<Record>& record_list(const DnsRecordSet& records) {
+    static const QList<Record> empty;
+    const QList<Record>* list = std::get_if<QList<Record>>(&records);
+    return list ? *list : empty;
+}
+
+/*Smallest TTL of the set, 0 if it is empty*/
+inline quint32 min_ttl(const DnsRecordSet& records) {
+    return std::visit([](const auto& list) {
+        quint32 ttl = list.isEmpty() ? 0 : list.first().ttl;
+        for (const auto& rec : list) {
+            ttl = qMin(ttl, rec.ttl);
+        }
+        return ttl;
+    }, records);
+}
+
+inline qsizetype record_count(const DnsRecordSet& records) {
+    return std::visit([](const auto& list) { return list.size(); }, records);
+}
+
+#endif // RECORDTRAITS_H
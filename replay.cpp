@@ -0,0 +1,121 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the replayer.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "replay.h"
+#include "display.h"
+
+#include <iostream>
+#include <limits>
+
+#include <QDnsLookup>
+#include <QTimer>
+
+//Observations delivered in one go with speed 0, before the event-loop gets control again
+static constexpr int FAST_BATCH = 1000;
+
+/*Only the error-code of a failed lookup is recorded, not its text*/
+static void apply_error(DnsDisplayData& data, const HistoryReader::Observation& observation) {
+    if (observation.error == 0) {
+        return;
+    }
+    data.error = static_cast<QDnsLookup::Error>(observation.error);
+    data.timeout = observation.timeout;
+    data.error_string = observation.timeout ? QString("Request timed out")
+                                            : QString("Lookup failed (error %1)").arg(observation.error);
+}
+
+Replayer::Replayer(HistoryReader* reader, Display* display, double speed, QObject* parent) :
+    QObject(parent), m_reader(reader), m_display(display), m_speed(speed) {}
+
+void Replayer::start() {
+    m_reader->rewind();
+    m_has_pending = m_reader->next(m_pending);
+    Replayer::step();
+}
+
+void Replayer::step() {
+    int batch = 0;
+    while (m_has_pending) {
+        const HistoryReader::Observation current = m_pending;
+        Replayer::deliver(current);
+        m_has_pending = m_reader->next(m_pending);
+        if (!m_has_pending) {
+            break;
+        }
+
+        if (m_speed > 0) {
+            const qint64 gap = qMax<qint64>(0, m_pending.time_ms - current.time_ms);
+            const double delay_ms = static_cast<double>(gap) / m_speed;
+            Replayer::wait(delay_ms < static_cast<double>(std::numeric_limits<qint64>::max())
+                           ? static_cast<qint64>(delay_ms) : std::numeric_limits<qint64>::max());
+            return;
+        }
+        if (++batch >= FAST_BATCH) {
+            QTimer::singleShot(0, this, [this]() {
+                Replayer::step();
+            });
+            return;
+        }
+    }
+
+    if (!m_reader->error_string().isEmpty()) {
+        std::cerr << m_reader->error_string().toStdString() << std::endl;
+    }
+    emit finished();
+}
+
+/*A timer takes at most INT_MAX ms (about 24.8 days), longer gaps are waited in chunks*/
+void Replayer::wait(qint64 delay_ms) {
+    const qint64 chunk_ms = qMin<qint64>(delay_ms, std::numeric_limits<int>::max());
+    QTimer::singleShot(static_cast<int>(chunk_ms), this, [this, delay_ms, chunk_ms]() {
+        if (delay_ms > chunk_ms) {
+            Replayer::wait(delay_ms - chunk_ms);
+        } else {
+            Replayer::step();
+        }
+    });
+}
+
+void Replayer::deliver(const HistoryReader::Observation& observation) {
+    const qint64 rtt_us = observation.rtt_us == 0xFFFFFFFF ? -1 : static_cast<qint64>(observation.rtt_us);
+    const auto key = qMakePair((static_cast<quint64>(observation.server_id) << 32) | observation.target_id, observation.hash_id);
+    const bool new_hash = !m_delivered.contains(key);
+    if (new_hash) {
+        m_delivered.insert(key);
+    }
+    ++m_replayed;
+    if (rtt_us >= 0) {
+        m_display->latency()->histogram(observation.server_id, observation.target_id)->record(rtt_us, observation.time_ms);
+    }
+
+    DnsDisplayData data;
+    data.server_id = observation.server_id;
+    data.target_id = observation.target_id;
+    data.server = m_reader->server(observation.server_id);
+    data.name = m_reader->target_name(observation.target_id);
+    data.type = static_cast<QDnsLookup::Type>(m_reader->target_type(observation.target_id));
+    data.hash_changed = observation.changed;
+    data.new_hash = new_hash;
+    data.cur_time_ms = observation.time_ms;
+    data.rtt_us = rtt_us;
+    data.ttl = observation.ttl;
+    data.cur_hash = m_reader->hash(observation.hash_id);
+    if (new_hash) {
+        data.cur_response = m_reader->records(observation.hash_id);
+    }
+    apply_error(data, observation);
+    m_display->update_display(data);
+}
@@ -0,0 +1,59 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The replayer reads a recorded binary history-log and feeds every
+ * observation into the display again, in the recorded time-distances
+ * scaled by the replay-speed. With speed 0 the log is replayed as fast
+ * as possible, e.g. to convert it into a csv-export.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <QObject>
+#include <QSet>
+
+#include "historylog.h"
+
+class Display;
+
+class Replayer : public QObject {
+    Q_OBJECT
+
+public:
+    Replayer(HistoryReader* reader, Display* display, double speed, QObject* parent = nullptr);
+
+    size_t replayed() const { return m_replayed; }
+
+public slots:
+    void start();
+
+signals:
+    void finished();
+
+private:
+    HistoryReader* m_reader;
+    Display* m_display;
+    double m_speed;
+    HistoryReader::Observation m_pending;
+    bool m_has_pending = false;
+    size_t m_replayed = 0;
+    //(server_id, target_id, hash_id) whose records were already delivered
+    QSet<QPair<quint64, quint32>> m_delivered;
+
+    void step();
+    void wait(qint64 delay_ms);
+    void deliver(const HistoryReader::Observation& observation);
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,80 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the RRset-store. The memory-usage is an estimate of
+ * the heap used by the records (structs plus string-data) and the keys.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "rrsetstore.h"
+
+namespace {
+
+inline size_t string_bytes(const QString& value) {
+    return static_cast<size_t>(value.capacity()) * sizeof(QChar);
+}
+
+//Heap-memory of a record beside its struct
+size_t record_bytes(const DnsARecord& rec) {
+    return string_bytes(rec.name);
+}
+
+size_t record_bytes(const DnsSrvRecord& rec) {
+    return string_bytes(rec.name) + string_bytes(rec.target);
+}
+
+size_t record_bytes(const DnsMxRecord& rec) {
+    return string_bytes(rec.name) + string_bytes(rec.exchange);
+}
+
+size_t record_bytes(const DnsTxtRecord& rec) {
+    size_t bytes = string_bytes(rec.name);
+    for (const auto& value : rec.values) {
+        bytes += sizeof(QByteArray) + static_cast<size_t>(value.capacity());
+    }
+    return bytes;
+}
+
+size_t record_bytes(const DnsNameRecord& rec) {
+    return string_bytes(rec.name) + string_bytes(rec.value);
+}
+
+}
+
+void RRsetStore::intern(const QByteArray& hash, const DnsRecordSet& records) {
+    if (m_entries.contains(hash)) {
+        return;
+    }
+    auto it = m_entries.insert(hash, Entry());
+    it->records = records;
+    ++m_stats.rrsets;
+    RRsetStore::account(*it, hash);
+}
+
+const DnsRecordSet& RRsetStore::records(const QByteArray& hash) const {
+    static const DnsRecordSet empty;
+    auto it = m_entries.constFind(hash);
+    return it != m_entries.constEnd() ? it->records : empty;
+}
+
+void RRsetStore::account(Entry& entry, const QByteArray& hash) {
+    size_t bytes = sizeof(Entry) + static_cast<size_t>(hash.capacity());
+    std::visit([&](const auto& list) {
+        for (const auto& rec : list) {
+            bytes += sizeof(rec) + record_bytes(rec);
+        }
+        entry.count = static_cast<size_t>(list.size());
+    }, entry.records);
+    entry.bytes = bytes;
+    m_stats.bytes += bytes;
+    m_stats.records += entry.count;
+}
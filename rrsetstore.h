@@ -0,0 +1,59 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Content-addressed store for RRsets. Every distinct answer is interned
+ * exactly once, keyed by its hash, and shared by all servers and targets
+ * which returned it. Like the occurrences pointing to them, the RRsets
+ * are kept for the whole run.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef RRSETSTORE_H
+#define RRSETSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+#include "dnsrecord.h"
+
+class RRsetStore {
+
+public:
+    struct Stats {
+        size_t rrsets = 0;
+        size_t records = 0;
+        size_t bytes = 0;
+    };
+
+    //Stores the records only for a hash not seen before
+    void intern(const QByteArray& hash, const DnsRecordSet& records);
+
+    bool contains(const QByteArray& hash) const { return m_entries.contains(hash); }
+    const DnsRecordSet& records(const QByteArray& hash) const;
+
+    Stats stats() const { return m_stats; }
+
+private:
+    struct Entry {
+        DnsRecordSet records;
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    QHash<QByteArray, Entry> m_entries;
+    Stats m_stats;
+
+    void account(Entry& entry, const QByteArray& hash);
+};
+
+#endif // RRSETSTORE_H
@@ -0,0 +1,116 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the scheduler. The wheel is advanced by the real
+ * elapsed time on every timer-tick, so a delayed Qt-timer only results
+ * in more ticks processed at once and never in lost polls.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "scheduler.h"
+#include "dnstracker.h"
+#include "clock.h"
+#include "tracing.h"
+
+#include <QRandomGenerator>
+
+Scheduler::Scheduler(qint64 tick_ms, QObject *parent)
+    : QObject(parent), m_tick_ms(tick_ms > 0 ? tick_ms : 1), m_timer(this), m_origin_ms(Clock::instance()->now_ms()) {
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(static_cast<int>(m_tick_ms));
+    QObject::connect(&m_timer, &QTimer::timeout, this, &Scheduler::on_tick);
+}
+
+quint32 Scheduler::add_target(DnsTracker* tracker) {
+    tracker->setParent(this);
+    m_targets.append(tracker);
+    return m_wheel.add_entry();
+}
+
+void Scheduler::schedule(quint32 id, qint64 delay_ms) {
+    //The wheel counts relative to its last processed tick, anchor the delay on the real clock
+    const quint64 now = Scheduler::now_tick();
+    const quint64 wheel_tick = m_wheel.current_tick();
+    const quint64 lag = now > wheel_tick ? now - wheel_tick : 0;
+    m_wheel.schedule(id, lag + Scheduler::to_ticks(delay_ms));
+}
+
+void Scheduler::schedule_with_jitter(quint32 id, qint64 window_ms) {
+    qint64 offset = 0;
+    if (window_ms > 0) {
+        offset = QRandomGenerator::global()->bounded(window_ms);
+    }
+    Scheduler::schedule(id, offset);
+}
+
+void Scheduler::cancel(quint32 id) {
+    m_wheel.cancel(id);
+}
+
+void Scheduler::start() {
+    if (!m_timer.isActive() && !Clock::instance()->is_virtual()) {
+        m_timer.start();
+    }
+}
+
+void Scheduler::stop() {
+    m_timer.stop();
+}
+
+void Scheduler::on_tick() {
+    const quint64 now = Scheduler::now_tick();
+    const quint64 wheel_tick = m_wheel.current_tick();
+    //The timer fires once per tick, every tick more than one is lag
+    const qint64 lag_ms = now > wheel_tick + 1 ? static_cast<qint64>(now - wheel_tick - 1) * m_tick_ms : 0;
+    m_last_lag_ms.store(lag_ms, std::memory_order_relaxed);
+    if (lag_ms > m_max_lag_ms.load(std::memory_order_relaxed)) {
+        m_max_lag_ms.store(lag_ms, std::memory_order_relaxed);
+    }
+    //The lag is the argument, so a late tick shows up next to the stages it delayed
+    TRACE_SCOPE("scheduler.tick", lag_ms);
+
+    Scheduler::run_due(now);
+}
+
+qint64 Scheduler::next_due_ms() const {
+    const quint64 tick = m_wheel.next_due_tick();
+    if (tick == TimerWheel::NO_TICK) {
+        return -1;
+    }
+    return m_origin_ms + static_cast<qint64>(tick) * m_tick_ms;
+}
+
+/*No lag in virtual time, the clock only moves when every due tick is processed*/
+void Scheduler::advance() {
+    Scheduler::run_due(Scheduler::now_tick());
+}
+
+void Scheduler::run_due(quint64 now) {
+    m_wheel.advance(now, [this](quint32 id) {
+        DnsTracker* tracker = m_targets[id];
+        if (tracker) {
+            tracker->poll();
+        }
+    });
+}
+
+quint64 Scheduler::now_tick() const {
+    const qint64 elapsed_ms = Clock::instance()->now_ms() - m_origin_ms;
+    return static_cast<quint64>(qMax<qint64>(0, elapsed_ms) / m_tick_ms);
+}
+
+quint64 Scheduler::to_ticks(qint64 delay_ms) const {
+    if (delay_ms <= 0) {
+        return 0;
+    }
+    return static_cast<quint64>((delay_ms + m_tick_ms - 1) / m_tick_ms);
+}
@@ -0,0 +1,82 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The scheduler is the central clock for all dns-tracker-objects in
+ * continues-mode. It owns every tracker, keeps their next poll in a
+ * timer-wheel and drives the wheel with one single Qt-timer. The start
+ * of every target is spread with a random offset over the interval, so
+ * not all requests are fired in the same tick.
+ * With a virtual clock the Qt-timer stays off, the simulation jumps the
+ * clock from one due tick to the next and advances the wheel itself.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QPointer>
+
+#include <atomic>
+
+#include "timerwheel.h"
+
+class DnsTracker;
+
+class Scheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit Scheduler(qint64 tick_ms = 10, QObject *parent = nullptr);
+
+    quint32 add_target(DnsTracker* tracker);
+    void schedule(quint32 id, qint64 delay_ms);
+    void schedule_with_jitter(quint32 id, qint64 window_ms);
+    void cancel(quint32 id);
+
+    qint64 tick_ms() const { return m_tick_ms; }
+    size_t target_count() const { return m_targets.size(); }
+    size_t pending() const { return m_wheel.pending(); }
+    //Delay of the tick-processing behind the real clock
+    qint64 last_lag_ms() const { return m_last_lag_ms.load(std::memory_order_relaxed); }
+    qint64 max_lag_ms() const { return m_max_lag_ms.load(std::memory_order_relaxed); }
+
+    //Virtual time: clock-time of the next tick with a due poll (lower bound), -1 if nothing is pending
+    qint64 next_due_ms() const;
+    //Virtual time: polls everything due up to the clock
+    void advance();
+
+public slots:
+    void start();
+    void stop();
+
+private slots:
+    void on_tick();
+
+private:
+    qint64 m_tick_ms;
+    QTimer m_timer;
+    //Clock-time of tick 0
+    qint64 m_origin_ms;
+    TimerWheel m_wheel;
+    QVector<QPointer<DnsTracker>> m_targets;
+    std::atomic<qint64> m_last_lag_ms{0};
+    std::atomic<qint64> m_max_lag_ms{0};
+
+    quint64 now_tick() const;
+    void run_due(quint64 now);
+    quint64 to_ticks(qint64 delay_ms) const;
+};
+
+#endif // SCHEDULER_H
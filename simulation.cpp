@@ -0,0 +1,120 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the simulation.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "simulation.h"
+#include "display.h"
+#include "scheduler.h"
+#include "trackerpool.h"
+
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+namespace {
+
+AnswerScript::Settings daily_changes(qint64 day_ms) {
+    AnswerScript::Settings settings;
+    settings.change_at_ms = day_ms;
+    settings.change_every_ms = day_ms;
+    return settings;
+}
+
+/*Resident memory in bytes, 0 if /proc is not available*/
+qint64 rss_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    qint64 size = 0;
+    qint64 resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+}
+
+Simulation::Simulation(qint64 start_ms, qint64 duration_ms)
+    : m_clock(start_ms), m_answers(daily_changes(DAY_MS)), m_start_ms(start_ms), m_duration_ms(duration_ms) {
+    m_answers.set_origin(start_ms);
+    Clock::install(&m_clock);
+}
+
+Simulation::~Simulation() {
+    Clock::install(nullptr);
+}
+
+bool Simulation::load_answers(const QString& filepath) {
+    return m_answers.load(filepath);
+}
+
+void Simulation::run(TrackerPool* pool, const Display* display, bool verbose) {
+    QElapsedTimer wall_clock;
+    wall_clock.start();
+    const QList<Scheduler*> schedulers = pool->schedulers();
+    const qint64 end_ms = m_start_ms + m_duration_ms;
+    qint64 next_report_ms = m_start_ms + DAY_MS;
+    quint64 events = 0;
+
+    //The trackers are started from the event-loop
+    QCoreApplication::processEvents();
+    while (!m_stopped) {
+        qint64 due_ms = -1;
+        for (Scheduler* scheduler : schedulers) {
+            const qint64 next_ms = scheduler->next_due_ms();
+            if (next_ms >= 0 && (due_ms < 0 || next_ms < due_ms)) {
+                due_ms = next_ms;
+            }
+        }
+        if (due_ms < 0 || due_ms > end_ms) {
+            break;
+        }
+        while (verbose && due_ms >= next_report_ms) {
+            Simulation::report(next_report_ms, pool, display);
+            next_report_ms += DAY_MS;
+        }
+
+        m_clock.advance_to(due_ms);
+        for (Scheduler* scheduler : schedulers) {
+            scheduler->advance();
+        }
+        //Frames, the export-flush and STRG+C run in between
+        if (++events % EVENTS_PER_PASS == 0) {
+            QCoreApplication::processEvents();
+        }
+    }
+    if (!m_stopped) {
+        m_clock.advance_to(end_ms);
+    }
+    QCoreApplication::processEvents();
+
+    const qint64 simulated_ms = m_clock.now_ms() - m_start_ms;
+    const qint64 wall_ms = qMax<qint64>(1, wall_clock.elapsed());
+    Simulation::report(m_clock.now_ms(), pool, display);
+    std::cerr << "Simulated " << static_cast<double>(simulated_ms) / DAY_MS << " days in " << wall_ms << " ms ("
+              << simulated_ms / wall_ms << "x real-time, " << events << " events)" << std::endl;
+}
+
+void Simulation::report(qint64 time_ms, TrackerPool* pool, const Display* display) const {
+    quint64 sent = 0;
+    quint64 fixed = 0;
+    pool->polling_report(sent, fixed);
+    const RRsetStore::Stats rrsets = display->rrset_stats();
+    std::cerr << "Day " << static_cast<double>(time_ms - m_start_ms) / DAY_MS << ": " << sent << " queries, "
+              << display->occurrence_count() << " occurrences, " << rrsets.rrsets << " RRsets (" << rrsets.bytes
+              << " bytes), RSS " << rss_bytes() / 1024 << " KB" << std::endl;
+}
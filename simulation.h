@@ -0,0 +1,62 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The simulation runs continues-mode in virtual time: it installs a
+ * virtual clock, the trackers get their answers from the answer-script
+ * and the clock jumps from one due poll to the next (discrete events),
+ * so weeks of polling take seconds.
+ * Every simulated day the growth of the display (occurrences, RRsets)
+ * and of the resident memory can be reported.
+ * The trackers have to run on the main-thread (one tracker-thread).
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <QString>
+
+#include "answerscript.h"
+#include "clock.h"
+
+class Display;
+class TrackerPool;
+
+class Simulation {
+
+public:
+    //Virtual time starts at start_ms, without a script every generated answer changes once per simulated day
+    Simulation(qint64 start_ms, qint64 duration_ms);
+    ~Simulation();
+
+    bool load_answers(const QString& filepath);
+    const AnswerScript* answers() const { return &m_answers; }
+
+    //Runs until the duration is simulated or stop is called, reports to stderr
+    void run(TrackerPool* pool, const Display* display, bool verbose);
+    void stop() { m_stopped = true; }
+
+private:
+    static constexpr qint64 DAY_MS = 24 * 3600 * 1000LL;
+    //Events between two passes of the Qt-event-loop
+    static constexpr quint64 EVENTS_PER_PASS = 64;
+
+    VirtualClock m_clock;
+    AnswerScript m_answers;
+    qint64 m_start_ms;
+    qint64 m_duration_ms;
+    bool m_stopped = false;
+
+    void report(qint64 time_ms, TrackerPool* pool, const Display* display) const;
+};
+
+#endif // SIMULATION_H
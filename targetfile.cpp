@@ -0,0 +1,186 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the target-file parser.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "targetfile.h"
+#include "recordtraits.h"
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <QFile>
+#include <QHostAddress>
+
+namespace {
+
+inline bool is_separator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+//Longest domain-name in text-form, with the trailing dot
+constexpr qsizetype MAX_NAME_SIZE = 254;
+//One week, longer intervals are no tracking anymore
+constexpr qint64 MAX_INTERVAL_SEC = 7 * 24 * 3600;
+
+}
+
+bool TargetFile::load(const QString& filepath) {
+    m_filepath = filepath;
+    m_entries.clear();
+    m_malformed = 0;
+
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::cerr << "Target-file could not be opened: " << filepath.toStdString() << std::endl;
+        return false;
+    }
+    const qsizetype size = file.size();
+    if (size == 0) {
+        return true;
+    }
+    const char* data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data) {
+        std::cerr << "Target-file could not be mapped: " << file.errorString().toStdString() << std::endl;
+        return false;
+    }
+
+    //A line of a watchlist is rarely shorter, so the list grows at most once or twice
+    m_entries.reserve(size / 32 + 1);
+    qsizetype pos = 0;
+    qsizetype line = 0;
+    while (pos < size) {
+        const char* begin = data + pos;
+        const char* end = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(size - pos)));
+        const qsizetype length = end ? end - begin : size - pos;
+        TargetFile::parse_line(begin, length, ++line);
+        pos += length + 1;
+    }
+    file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+
+    if (m_malformed > 0) {
+        std::cerr << m_malformed << " malformed line(s) in target-file " << filepath.toStdString() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void TargetFile::parse_line(const char* data, qsizetype size, qsizetype line) {
+    const char* comment = static_cast<const char*>(std::memchr(data, '#', static_cast<size_t>(size)));
+    if (comment) {
+        size = comment - data;
+    }
+
+    Field fields[MAX_FIELDS];
+    int count = 0;
+    qsizetype pos = 0;
+    while (pos < size) {
+        while (pos < size && is_separator(data[pos])) {
+            ++pos;
+        }
+        if (pos == size) {
+            break;
+        }
+        const qsizetype start = pos;
+        while (pos < size && !is_separator(data[pos])) {
+            ++pos;
+        }
+        if (count == MAX_FIELDS) {
+            TargetFile::report(line, "too many fields, expected NAME TYPE SERVER [INTERVAL]");
+            return;
+        }
+        fields[count++] = {data + start, pos - start};
+    }
+
+    if (count == 0) {
+        return;
+    }
+    if (count < 3) {
+        TargetFile::report(line, "missing fields, expected NAME TYPE SERVER [INTERVAL]");
+        return;
+    }
+    if (fields[0].size > MAX_NAME_SIZE) {
+        TargetFile::report(line, "DNS-name is longer than " + std::to_string(MAX_NAME_SIZE) + " characters");
+        return;
+    }
+
+    TargetEntry entry;
+    if (!TargetFile::parse_type(fields[1], entry.type)) {
+        TargetFile::report(line, "unsupported DNS-type '" + std::string(fields[1].data, static_cast<size_t>(fields[1].size)) + "'");
+        return;
+    }
+    if (!TargetFile::parse_server(fields[2], entry.server)) {
+        TargetFile::report(line, "invalid DNS-server '" + std::string(fields[2].data, static_cast<size_t>(fields[2].size)) + "'");
+        return;
+    }
+    if (count == 4 && !TargetFile::parse_interval(fields[3], entry.interval_ms)) {
+        TargetFile::report(line, "invalid interval '" + std::string(fields[3].data, static_cast<size_t>(fields[3].size))
+                                 + "', expected seconds between 1 and " + std::to_string(MAX_INTERVAL_SEC) + " or -");
+        return;
+    }
+    entry.name = QString::fromUtf8(fields[0].data, fields[0].size);
+    m_entries.append(entry);
+}
+
+bool TargetFile::parse_type(const Field& field, QDnsLookup::Type& type) {
+    //fromRawData does not copy, only a new spelling is stored
+    const QByteArray key = QByteArray::fromRawData(field.data, field.size);
+    auto it = m_types.constFind(key);
+    if (it != m_types.constEnd()) {
+        type = it.value();
+        return true;
+    }
+    if (!parse_record_type(QString::fromLatin1(field.data, field.size), type)) {
+        return false;
+    }
+    m_types.insert(QByteArray(field.data, field.size), type);
+    return true;
+}
+
+bool TargetFile::parse_server(const Field& field, QString& server) {
+    const QByteArray key = QByteArray::fromRawData(field.data, field.size);
+    auto it = m_servers.constFind(key);
+    if (it != m_servers.constEnd()) {
+        //Shared copy, all targets of a server hold the same string
+        server = it.value();
+        return true;
+    }
+    server = QString::fromLatin1(field.data, field.size);
+    if (QHostAddress(server).isNull()) {
+        return false;
+    }
+    m_servers.insert(QByteArray(field.data, field.size), server);
+    return true;
+}
+
+bool TargetFile::parse_interval(const Field& field, qint64& interval_ms) {
+    if (field.size == 1 && field.data[0] == '-') {
+        interval_ms = -1;
+        return true;
+    }
+    qint64 sec = 0;
+    const auto result = std::from_chars(field.data, field.data + field.size, sec);
+    if (result.ec != std::errc() || result.ptr != field.data + field.size || sec <= 0 || sec > MAX_INTERVAL_SEC) {
+        return false;
+    }
+    interval_ms = sec * 1000;
+    return true;
+}
+
+void TargetFile::report(qsizetype line, const std::string& message) {
+    ++m_malformed;
+    std::cerr << m_filepath.toStdString() << ":" << line << ": " << message << std::endl;
+}
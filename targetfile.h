@@ -0,0 +1,76 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The target-file is the watchlist for large measurements, so all
+ * targets run in one process instead of one process per name.
+ * One target per line, fields separated by blanks, tabs or commas:
+ *
+ *   NAME TYPE SERVER [INTERVAL]
+ *
+ * INTERVAL is the poll-interval of continues-mode in seconds, without it
+ * (or with "-") the interval of the command-line is used. Everything
+ * after '#' is a comment, empty lines are skipped.
+ * The file is memory-mapped and parsed in one pass without copying
+ * lines, types and servers are resolved once per distinct spelling.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef TARGETFILE_H
+#define TARGETFILE_H
+
+#include <string>
+
+#include <QByteArray>
+#include <QDnsLookup>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+struct TargetEntry {
+    QString name;
+    QString server;
+    QDnsLookup::Type type = QDnsLookup::A;
+    //Poll-interval of continues-mode, -1 keeps the one of the command-line
+    qint64 interval_ms = -1;
+};
+
+class TargetFile {
+
+public:
+    //Every malformed line is reported with its number, false if the file could not be read or had one
+    bool load(const QString& filepath);
+
+    const QList<TargetEntry>& entries() const { return m_entries; }
+    int malformed_lines() const { return m_malformed; }
+
+private:
+    struct Field {
+        const char* data = nullptr;
+        qsizetype size = 0;
+    };
+    static constexpr int MAX_FIELDS = 4;
+
+    QString m_filepath;
+    QList<TargetEntry> m_entries;
+    int m_malformed = 0;
+    //Keyed by the spelling in the file, so every distinct type and server is checked once
+    QHash<QByteArray, QDnsLookup::Type> m_types;
+    QHash<QByteArray, QString> m_servers;
+
+    void parse_line(const char* data, qsizetype size, qsizetype line);
+    bool parse_type(const Field& field, QDnsLookup::Type& type);
+    bool parse_server(const Field& field, QString& server);
+    static bool parse_interval(const Field& field, qint64& interval_ms);
+    void report(qsizetype line, const std::string& message);
+};
+
+#endif // TARGETFILE_H
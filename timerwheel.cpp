@@ -0,0 +1,138 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the hierarchical timer-wheel. The slot-layout
+ * follows the classic kernel-wheel: slot 0..255 is the root-level with
+ * one tick per slot, every upper level covers 64 slots of the level
+ * below.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "timerwheel.h"
+
+TimerWheel::TimerWheel(quint64 start_tick)
+    : m_tick(start_tick), m_slots(SLOT_COUNT, INVALID_ID) {}
+
+quint32 TimerWheel::add_entry() {
+    m_nodes.append(Node());
+    return static_cast<quint32>(m_nodes.size() - 1);
+}
+
+void TimerWheel::schedule(quint32 id, quint64 delay_ticks) {
+    if (id >= static_cast<quint32>(m_nodes.size())) {
+        return;
+    }
+    if (m_nodes[id].slot != INVALID_ID) {
+        unlink(id);
+    }
+    m_nodes[id].due = false;
+    m_nodes[id].expires = m_tick + delay_ticks;
+    link(id);
+}
+
+void TimerWheel::cancel(quint32 id) {
+    if (id >= static_cast<quint32>(m_nodes.size())) {
+        return;
+    }
+    m_nodes[id].due = false;
+    if (m_nodes[id].slot != INVALID_ID) {
+        unlink(id);
+    }
+}
+
+bool TimerWheel::is_armed(quint32 id) const {
+    return id < static_cast<quint32>(m_nodes.size()) && m_nodes[id].slot != INVALID_ID;
+}
+
+/*Only the root-slots up to the next wrap are looked at, upper entries are found once they cascade down*/
+quint64 TimerWheel::next_due_tick() const {
+    if (m_pending == 0) {
+        return NO_TICK;
+    }
+    const quint64 wrap = (m_tick | ROOT_MASK) + 1;
+    for (quint64 tick = m_tick; tick < wrap; ++tick) {
+        if (m_slots[tick & ROOT_MASK] != INVALID_ID) {
+            return tick;
+        }
+    }
+    return wrap;
+}
+
+void TimerWheel::link(quint32 id) {
+    Node& node = m_nodes[id];
+    const quint64 expires = node.expires;
+    quint64 delta = expires > m_tick ? expires - m_tick : 0;
+
+    quint32 slot;
+    if (delta < ROOT_SIZE) {
+        slot = (delta == 0 ? m_tick : expires) & ROOT_MASK;
+    } else {
+        //Entries beyond the wheel-range are parked in the last reachable slot
+        //and re-evaluated with their real expiry on every cascade
+        quint64 target = expires;
+        if (delta > MAX_DELTA) {
+            delta = MAX_DELTA;
+            target = m_tick + MAX_DELTA;
+        }
+        int level = 0;
+        while (level < UPPER_LEVELS - 1 && delta >= (quint64(1) << (ROOT_BITS + (level + 1) * LEVEL_BITS))) {
+            ++level;
+        }
+        const int shift = ROOT_BITS + level * LEVEL_BITS;
+        slot = ROOT_SIZE + level * LEVEL_SIZE + ((target >> shift) & LEVEL_MASK);
+    }
+
+    node.slot = slot;
+    node.prev = INVALID_ID;
+    node.next = m_slots[slot];
+    if (node.next != INVALID_ID) {
+        m_nodes[node.next].prev = id;
+    }
+    m_slots[slot] = id;
+    ++m_pending;
+}
+
+void TimerWheel::unlink(quint32 id) {
+    Node& node = m_nodes[id];
+    if (node.prev != INVALID_ID) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_slots[node.slot] = node.next;
+    }
+    if (node.next != INVALID_ID) {
+        m_nodes[node.next].prev = node.prev;
+    }
+    node.prev = INVALID_ID;
+    node.next = INVALID_ID;
+    node.slot = INVALID_ID;
+    --m_pending;
+}
+
+quint32 TimerWheel::detach_slot(quint32 slot) {
+    const quint32 head = m_slots[slot];
+    m_slots[slot] = INVALID_ID;
+    return head;
+}
+
+void TimerWheel::cascade(int level) {
+    const int shift = ROOT_BITS + level * LEVEL_BITS;
+    const quint32 slot = ROOT_SIZE + level * LEVEL_SIZE + ((m_tick >> shift) & LEVEL_MASK);
+
+    quint32 id = detach_slot(slot);
+    while (id != INVALID_ID) {
+        const quint32 next = m_nodes[id].next;
+        m_nodes[id].slot = INVALID_ID;
+        --m_pending;
+        link(id);
+        id = next;
+    }
+}
@@ -0,0 +1,121 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The timer-wheel is a hierarchical hashed wheel (4 levels, 256/64/64/64
+ * slots) which holds the expiry of every registered entry. Every entry
+ * lives in exactly one slot as node of an intrusive double-linked list,
+ * so scheduling, cancel and expiry are O(1) and a tick only touches the
+ * slot that is due, no matter how many entries are registered.
+ * Entries of the upper levels are cascaded down once the lower level
+ * wraps around.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QtGlobal>
+#include <QVector>
+
+class TimerWheel {
+
+public:
+    static constexpr quint32 INVALID_ID = 0xFFFFFFFF;
+    static constexpr quint64 NO_TICK = ~quint64(0);
+
+    explicit TimerWheel(quint64 start_tick = 0);
+
+    quint32 add_entry();
+    void schedule(quint32 id, quint64 delay_ticks);
+    void cancel(quint32 id);
+    bool is_armed(quint32 id) const;
+
+    template <typename Callback>
+    void advance(quint64 now_tick, Callback&& on_expire);
+
+    //Lower bound of the next tick with a due entry, at most the next cascade, NO_TICK if nothing is pending
+    quint64 next_due_tick() const;
+
+    quint64 current_tick() const { return m_tick; }
+    size_t pending() const { return m_pending; }
+    size_t size() const { return m_nodes.size(); }
+
+private:
+    static constexpr int ROOT_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr quint32 ROOT_SIZE = 1u << ROOT_BITS;
+    static constexpr quint32 LEVEL_SIZE = 1u << LEVEL_BITS;
+    static constexpr quint32 ROOT_MASK = ROOT_SIZE - 1;
+    static constexpr quint32 LEVEL_MASK = LEVEL_SIZE - 1;
+    static constexpr int UPPER_LEVELS = 3;
+    static constexpr quint32 SLOT_COUNT = ROOT_SIZE + UPPER_LEVELS * LEVEL_SIZE;
+    static constexpr quint64 MAX_DELTA = (quint64(1) << (ROOT_BITS + UPPER_LEVELS * LEVEL_BITS)) - 1;
+
+    struct Node {
+        quint64 expires = 0;
+        quint32 prev = INVALID_ID;
+        quint32 next = INVALID_ID;
+        quint32 slot = INVALID_ID;
+        bool due = false;
+    };
+
+    quint64 m_tick;
+    size_t m_pending = 0;
+    QVector<Node> m_nodes;
+    QVector<quint32> m_slots;
+    QVector<quint32> m_expired;
+
+    void link(quint32 id);
+    void unlink(quint32 id);
+    quint32 detach_slot(quint32 slot);
+    void cascade(int level);
+};
+
+template <typename Callback>
+void TimerWheel::advance(quint64 now_tick, Callback&& on_expire) {
+    while (m_tick <= now_tick) {
+        const quint32 index = m_tick & ROOT_MASK;
+        if (index == 0) {
+            for (int level = 0; level < UPPER_LEVELS; ++level) {
+                cascade(level);
+                if (((m_tick >> (ROOT_BITS + level * LEVEL_BITS)) & LEVEL_MASK) != 0) {
+                    break;
+                }
+            }
+        }
+
+        //Collect first, so the callback is free to re-schedule or cancel any entry
+        m_expired.clear();
+        quint32 id = detach_slot(index);
+        while (id != INVALID_ID) {
+            Node& node = m_nodes[id];
+            const quint32 next = node.next;
+            node.prev = INVALID_ID;
+            node.next = INVALID_ID;
+            node.slot = INVALID_ID;
+            node.due = true;
+            --m_pending;
+            m_expired.append(id);
+            id = next;
+        }
+        ++m_tick;
+
+        for (const quint32 expired : m_expired) {
+            if (m_nodes[expired].due) {
+                m_nodes[expired].due = false;
+                on_expire(expired);
+            }
+        }
+    }
+}
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,142 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the trace-rings and the Chrome trace-export.
+ * A ring is registered once per thread and never freed, so the events of
+ * finished threads are still in the dump.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "tracing.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QThread>
+
+namespace {
+
+struct Event {
+    const char* name = nullptr;
+    qint64 begin_us = 0;
+    qint64 duration_us = 0;
+    qint64 arg = -1;
+};
+
+struct Ring {
+    int tid = 0;
+    std::string thread_name;
+    std::vector<Event> events = std::vector<Event>(Tracing::RING_SIZE);
+    //Only the owning thread writes, the dump reads the count with acquire
+    std::atomic<quint64> written{0};
+};
+
+std::mutex s_rings_mutex;
+std::vector<std::unique_ptr<Ring>> s_rings;
+thread_local Ring* t_ring = nullptr;
+
+const std::chrono::steady_clock::time_point& origin() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+Ring* local_ring() {
+    if (t_ring) {
+        return t_ring;
+    }
+    auto ring = std::make_unique<Ring>();
+    QThread* thread = QThread::currentThread();
+    const QCoreApplication* app = QCoreApplication::instance();
+    if (app && thread == app->thread()) {
+        ring->thread_name = "main";
+    } else if (thread && !thread->objectName().isEmpty()) {
+        ring->thread_name = thread->objectName().toStdString();
+    }
+
+    std::lock_guard<std::mutex> lock(s_rings_mutex);
+    ring->tid = static_cast<int>(s_rings.size()) + 1;
+    if (ring->thread_name.empty()) {
+        ring->thread_name = "thread-" + std::to_string(ring->tid);
+    }
+    t_ring = ring.get();
+    s_rings.push_back(std::move(ring));
+    return t_ring;
+}
+
+void write_escaped(std::ostream& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+
+}
+
+qint64 Tracing::now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin()).count();
+}
+
+void Tracing::complete(const char* name, qint64 begin_us, qint64 arg) {
+    Ring* ring = local_ring();
+    const quint64 index = ring->written.load(std::memory_order_relaxed);
+    Event& event = ring->events[index & (RING_SIZE - 1)];
+    event.name = name;
+    event.begin_us = begin_us;
+    event.duration_us = Tracing::now_us() - begin_us;
+    event.arg = arg;
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+bool Tracing::dump(const QString& filepath) {
+    std::ofstream out(filepath.toStdString(), std::ios::trunc);
+    if (!out) {
+        std::cerr << "Trace could not be written: " << filepath.toStdString() << std::endl;
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(s_rings_mutex);
+    for (const auto& ring : s_rings) {
+        out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << ring->tid
+            << ", \"args\": {\"name\": \"";
+        write_escaped(out, ring->thread_name);
+        out << "\"}}";
+        first = false;
+
+        const quint64 written = ring->written.load(std::memory_order_acquire);
+        const quint64 begin = written > RING_SIZE ? written - RING_SIZE : 0;
+        for (quint64 i = begin; i < written; ++i) {
+            const Event& event = ring->events[i & (RING_SIZE - 1)];
+            if (!event.name) {
+                continue;
+            }
+            out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"dns\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ring->tid
+                << ", \"ts\": " << event.begin_us << ", \"dur\": " << event.duration_us;
+            if (event.arg >= 0) {
+                out << ", \"args\": {\"id\": " << event.arg << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,78 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Tracing of the hot-path stages (scheduler-tick, send and resolve of a
+ * lookup, hashing, display-update, rendering, export), built only with
+ * DNS_TRACKER_HAVE_TRACING (cmake -DDNS_TRACKER_TRACING=ON). Without it
+ * every TRACE_-macro is empty and nothing is recorded.
+ * Every thread writes its events into an own ring-buffer without locks,
+ * only the newest events per thread are kept. The dump writes them as
+ * Chrome trace-events (JSON), which can be opened in Perfetto or
+ * chrome://tracing.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QtGlobal>
+#include <QString>
+
+namespace Tracing {
+
+#ifdef DNS_TRACKER_HAVE_TRACING
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+//Events kept per thread, older ones are overwritten
+constexpr quint32 RING_SIZE = 1u << 16;
+
+//Monotonic µs since the first call
+qint64 now_us();
+//Stage name has to be a string-literal, arg is shown in the trace (-1: none)
+void complete(const char* name, qint64 begin_us, qint64 arg);
+//Snapshot of all rings, events written during the dump may be torn
+bool dump(const QString& filepath);
+
+/*Records the lifetime of the scope as one event*/
+class Scope {
+
+public:
+    explicit Scope(const char* name, qint64 arg = -1) : m_name(name), m_arg(arg), m_begin_us(now_us()) {}
+    ~Scope() { complete(m_name, m_begin_us, m_arg); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_arg;
+    qint64 m_begin_us;
+};
+
+}
+
+#ifdef DNS_TRACKER_HAVE_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, arg) Tracing::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name, arg)
+#define TRACE_COMPLETE(name, begin_us, arg) Tracing::complete(name, begin_us, arg)
+#define TRACE_NOW() Tracing::now_us()
+#else
+#define TRACE_SCOPE(name, arg) do {} while (false)
+#define TRACE_COMPLETE(name, begin_us, arg) do {} while (false)
+#define TRACE_NOW() qint64(0)
+#endif
+
+#endif // TRACING_H
@@ -0,0 +1,284 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * Implementation of the tracker-pool and its workers.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#include "trackerpool.h"
+#include "display.h"
+#include "scheduler.h"
+#include "dnsresolver.h"
+#include "tracing.h"
+
+#include <iostream>
+
+#include <QHostAddress>
+#include <QMetaObject>
+#include <QTimer>
+
+TrackerWorker::TrackerWorker(QObject* parent) : QObject(parent) {}
+
+/*Runs in the thread of the worker, so sockets and timers belong to it*/
+bool TrackerWorker::setup(const QList<TrackerTarget>& targets) {
+    m_scheduler = new Scheduler(10, this);
+
+    for (const auto& target : targets) {
+        const Options& opts = target.options;
+        m_continue = m_continue || opts.continue_measurment;
+
+        //Native backend: one resolver (socket) per server and worker, shared by all names
+        DnsResolver* resolver = nullptr;
+        if (opts.native_backend) {
+            resolver = m_resolvers.value(opts.dns_server);
+            if (!resolver) {
+                QHostAddress address(opts.dns_server);
+                if (address.isNull()) {
+                    std::cerr << "Invalid DNS-server: " << opts.dns_server.toStdString() << std::endl;
+                    return false;
+                }
+                resolver = new DnsResolver(address, opts.dns_port, this);
+                resolver->set_timeout(opts.timeout_ms);
+                if (opts.batched_io) {
+                    resolver->enable_batching(opts.io_uring ? BatchSocket::Mode::Uring : BatchSocket::Mode::Mmsg, opts.io_stats);
+                }
+                m_resolvers.insert(opts.dns_server, resolver);
+            }
+        }
+
+        auto tracker = new DnsTracker(opts, this);
+        m_trackers.append(tracker);
+        if (opts.continue_measurment) {
+            tracker->attach_scheduler(m_scheduler);
+        }
+        tracker->attach_latency(target.latency);
+        if (target.metrics) {
+            tracker->attach_metrics(target.metrics);
+        }
+        if (target.limiter) {
+            tracker->attach_limiter(target.limiter);
+        }
+        if (target.answers) {
+            tracker->attach_answers(target.answers);
+        }
+        if (resolver && !tracker->attach_resolver(resolver)) {
+            return false;
+        }
+
+        //Direct, the tracker is deleted later and still readable here
+        connect(tracker, &DnsTracker::finished, this, [this, tracker]() {
+            m_finished.insert(tracker);
+            m_finished_sent += tracker->queries_sent();
+            m_finished_fixed += qMax(tracker->queries_sent(), tracker->fixed_interval_queries());
+        }, Qt::DirectConnection);
+        connect(tracker, &DnsTracker::finished, this, &TrackerWorker::tracker_finished);
+        connect(tracker, &DnsTracker::send_update, this, &TrackerWorker::update);
+    }
+    return true;
+}
+
+void TrackerWorker::start() {
+    for (const auto& tracker : m_trackers) {
+        DnsTracker* target = tracker.data();
+        QTimer::singleShot(0, target, [target]() {
+            target->start();
+        });
+    }
+    if (m_continue) {
+        m_scheduler->start();
+    }
+}
+
+void TrackerWorker::reply_report(quint64& received, quint64& reused) const {
+    for (const auto resolver : m_resolvers) {
+        received += resolver->replies_received();
+        reused += resolver->replies_reused();
+    }
+}
+
+void TrackerWorker::stop_target(quint32 target_id) {
+    for (const auto& tracker : m_trackers) {
+        if (tracker && tracker->target_id() == target_id) {
+            tracker->stop();
+        }
+    }
+}
+
+void TrackerWorker::polling_report(quint64& sent, quint64& fixed) const {
+    sent += m_finished_sent;
+    fixed += m_finished_fixed;
+    for (const auto& tracker : m_trackers) {
+        if (tracker && !m_finished.contains(tracker.data())) {
+            sent += tracker->queries_sent();
+            fixed += qMax(tracker->queries_sent(), tracker->fixed_interval_queries());
+        }
+    }
+}
+
+TrackerPool::TrackerPool(Display* display, QObject* parent) : QObject(parent), m_display(display) {}
+
+TrackerPool::~TrackerPool() {
+    TrackerPool::stop();
+}
+
+bool TrackerPool::start(const QList<TrackerTarget>& targets, int threads) {
+    if (threads <= 0) {
+        threads = QThread::idealThreadCount();
+    }
+    threads = qMax(1, qMin(threads, static_cast<int>(targets.size())));
+    m_active = static_cast<size_t>(targets.size());
+
+    //Round-robin, so the targets of one name are spread over all workers
+    QList<QList<TrackerTarget>> shards;
+    shards.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        shards.append(QList<TrackerTarget>());
+    }
+    for (qsizetype i = 0; i < targets.size(); ++i) {
+        shards[static_cast<int>(i % threads)].append(targets.at(i));
+    }
+
+    //One thread: the trackers stay on the main-thread and update the display directly
+    if (threads == 1) {
+        auto worker = new TrackerWorker(this);
+        m_workers.push_back(worker);
+        connect(worker, &TrackerWorker::update, m_display.data(), &Display::update_display);
+        connect(worker, &TrackerWorker::tracker_finished, this, &TrackerPool::on_tracker_finished);
+        if (!worker->setup(shards.first())) {
+            return false;
+        }
+        worker->start();
+        return true;
+    }
+
+    for (int i = 0; i < threads; ++i) {
+        auto thread = new QThread(this);
+        thread->setObjectName(QString("tracker-%1").arg(i));
+        auto worker = new TrackerWorker();
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        m_threads.push_back(thread);
+        m_workers.push_back(worker);
+
+        //Direct: runs on the worker-thread, only the queues are shared
+        connect(worker, &TrackerWorker::update, worker, [this](const DnsDisplayData& data) {
+            m_queue.push(data);
+            TrackerPool::publish();
+        }, Qt::DirectConnection);
+        connect(worker, &TrackerWorker::tracker_finished, this, &TrackerPool::on_tracker_finished, Qt::QueuedConnection);
+
+        thread->start();
+        bool ok = false;
+        const QList<TrackerTarget>& shard = shards.at(i);
+        QMetaObject::invokeMethod(worker, [worker, &shard, &ok]() {
+            ok = worker->setup(shard);
+        }, Qt::BlockingQueuedConnection);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    for (auto worker : m_workers) {
+        QMetaObject::invokeMethod(worker, &TrackerWorker::start, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+/*Stops the worker-threads, the events they have left are drained into the display*/
+void TrackerPool::stop() {
+    for (auto thread : m_threads) {
+        thread->quit();
+    }
+    for (auto thread : m_threads) {
+        thread->wait();
+    }
+    if (!m_threads.empty()) {
+        TrackerPool::drain();
+    }
+    m_threads.clear();
+    m_workers.clear();
+}
+
+QList<Scheduler*> TrackerPool::schedulers() const {
+    QList<Scheduler*> result;
+    for (auto worker : m_workers) {
+        result.append(worker->scheduler());
+    }
+    return result;
+}
+
+/*Has to be called before stop(), the counters are read on the thread of each worker*/
+void TrackerPool::polling_report(quint64& sent, quint64& fixed) const {
+    for (auto worker : m_workers) {
+        if (worker->thread() == QThread::currentThread()) {
+            worker->polling_report(sent, fixed);
+        } else {
+            QMetaObject::invokeMethod(worker, [worker, &sent, &fixed]() {
+                worker->polling_report(sent, fixed);
+            }, Qt::BlockingQueuedConnection);
+        }
+    }
+}
+
+/*Has to be called before stop(), like the polling-report*/
+void TrackerPool::reply_report(quint64& received, quint64& reused) const {
+    for (auto worker : m_workers) {
+        if (worker->thread() == QThread::currentThread()) {
+            worker->reply_report(received, reused);
+        } else {
+            QMetaObject::invokeMethod(worker, [worker, &received, &reused]() {
+                worker->reply_report(received, reused);
+            }, Qt::BlockingQueuedConnection);
+        }
+    }
+}
+
+/*Queued, so a tracker is never stopped from within its own update*/
+void TrackerPool::stop_target(quint32 target_id) {
+    for (auto worker : m_workers) {
+        QMetaObject::invokeMethod(worker, [worker, target_id]() {
+            worker->stop_target(target_id);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void TrackerPool::on_tracker_finished() {
+    if (m_active > 0 && --m_active == 0) {
+        emit finished();
+    }
+}
+
+/*Called by the workers after a push, only the first push after a drain posts a new one*/
+void TrackerPool::publish() {
+    if (!m_drain_posted.exchange(true, std::memory_order_seq_cst)) {
+        QMetaObject::invokeMethod(this, [this]() {
+            TrackerPool::drain();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void TrackerPool::drain() {
+    if (!m_display) {
+        return;
+    }
+    TRACE_SCOPE("pool.drain", -1);
+    /*Cleared before popping, a push after the last pop posts the next drain. Both sides use a
+      read-modify-write on the flag: either this one is ordered after the one of publish() and
+      sees its push, or publish() reads false and posts the next drain. A plain store here
+      could miss the push while publish() still reads true*/
+    m_drain_posted.exchange(false, std::memory_order_seq_cst);
+
+    DnsDisplayData data;
+    while (m_queue.pop(data)) {
+        m_display->update_display(data);
+    }
+}
@@ -0,0 +1,129 @@
+/********************************************************************
+ * DNS-Tracker
+ *
+ * This tool is build for use at DTAG and Deutsche Telekom Technik.
+ * The purpose of this program is to trigger the DTAG-BPA-DNS-resolver
+ * to monitor changes on external DNS-side.
+ * The goal is to verify the delay of changing the DNS-response at
+ * DTAG-internal systems and made the change available for the customers
+ * on DTAG-external-site
+ *
+ * Purpose of this file:
+ * The tracker-pool shards the targets over worker-threads. Every worker
+ * runs its own event-loop with its own scheduler, resolvers (sockets)
+ * and trackers, so lookups and hashing of one shard never wait for
+ * another one.
+ * The update-events of all workers are pushed into a lock-free queue and
+ * drained on the main-thread, which keeps the display, the rendering and
+ * the exports single-threaded.
+ * With one thread the trackers run on the main-thread as before.
+ *
+ * Author: Dennis Kuehnlein (2025)
+********************************************************************/
+
+#ifndef TRACKERPOOL_H
+#define TRACKERPOOL_H
+
+#include <atomic>
+#include <vector>
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QPointer>
+#include <QSet>
+#include <QThread>
+
+#include "dnstracker.h"
+#include "mpscqueue.h"
+
+class Display;
+class Scheduler;
+class DnsResolver;
+class RateLimiter;
+class AnswerScript;
+
+/*Everything a worker needs for one tracker, prepared on the main-thread*/
+struct TrackerTarget {
+    Options options;
+    LatencyHistogram* latency = nullptr;
+    TargetMetrics* metrics = nullptr;
+    //Shared by all targets of the server, owned by the caller
+    RateLimiter* limiter = nullptr;
+    //Simulation: scripted answers instead of lookups, owned by the caller
+    const AnswerScript* answers = nullptr;
+};
+
+class TrackerWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TrackerWorker(QObject* parent = nullptr);
+
+    bool setup(const QList<TrackerTarget>& targets);
+    Scheduler* scheduler() const { return m_scheduler; }
+    void polling_report(quint64& sent, quint64& fixed) const;
+    void reply_report(quint64& received, quint64& reused) const;
+
+public slots:
+    void start();
+    //Stops the trackers of the target on every server of the worker
+    void stop_target(quint32 target_id);
+
+signals:
+    void update(const DnsDisplayData& data);
+    void tracker_finished();
+
+private:
+    Scheduler* m_scheduler = nullptr;
+    QMap<QString, DnsResolver*> m_resolvers;
+    QList<QPointer<DnsTracker>> m_trackers;
+    bool m_continue = false;
+    //Counters of trackers which already finished, e.g. stopped after convergence
+    QSet<const DnsTracker*> m_finished;
+    quint64 m_finished_sent = 0;
+    quint64 m_finished_fixed = 0;
+};
+
+class TrackerPool : public QObject {
+    Q_OBJECT
+
+public:
+    TrackerPool(Display* display, QObject* parent = nullptr);
+    ~TrackerPool();
+
+    //threads = 0 picks one thread per core, but never more than targets
+    bool start(const QList<TrackerTarget>& targets, int threads);
+    void stop();
+
+    int thread_count() const { return static_cast<int>(m_workers.size()); }
+    QList<Scheduler*> schedulers() const;
+    void polling_report(quint64& sent, quint64& fixed) const;
+    //Native backend: replies received and replies equal to the previous one, neither parsed nor hashed
+    void reply_report(quint64& received, quint64& reused) const;
+
+public slots:
+    //The trackers of a target can be sharded over several workers
+    void stop_target(quint32 target_id);
+
+signals:
+    void finished();
+
+private slots:
+    void on_tracker_finished();
+
+private:
+    QPointer<Display> m_display;
+    std::vector<QThread*> m_threads;
+    std::vector<TrackerWorker*> m_workers;
+    size_t m_active = 0;
+
+    //Filled by the workers, drained by the main-thread
+    MpscQueue<DnsDisplayData> m_queue;
+    std::atomic<bool> m_drain_posted{false};
+
+    void publish();
+    void drain();
+};
+
+#endif // TRACKERPOOL_H